@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <string.h>
+#include "display_pages.h"
+
+typedef void (*page_render_fn)(const display_state_t *st, const struct tm *tmv,
+                               const struct timeval *tv, frame_t *out);
+
+const char *const page_names[PAGE_COUNT] = {
+    [PAGE_NONE]    = "none",
+    [PAGE_BLANK]   = "blank",
+    [PAGE_TIME]    = "time",
+    [PAGE_TIME12]  = "time12",
+    [PAGE_DATE]    = "date",
+    [PAGE_SECONDS] = "seconds",
+    [PAGE_YEAR]    = "year",
+    [PAGE_VALUE]   = "value",
+    [PAGE_CHRONO]  = "chrono",
+};
+
+static inline uint8_t blink_dot(const struct timeval *tv)
+{
+    // Blink phase from wall clock, so synced clocks blink together
+    return (tv->tv_usec < 500000) ? HIGH : LOW;
+}
+
+static inline void frame_put2(frame_t *f, int pos, int value)
+{
+    f->digit[pos]     = (uint8_t)(value / 10 % 10);
+    f->digit[pos + 1] = (uint8_t)(value % 10);
+}
+
+static void render_none(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    for (int i = 0; i < 4; i++) { out->digit[i] = GLYPH_HYPHEN; out->dot[i] = LOW; }
+}
+
+static void render_blank(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    for (int i = 0; i < 4; i++) { out->digit[i] = GLYPH_BLANK; out->dot[i] = LOW; }
+}
+
+/* HH:MM, blinking dot after the hours */
+static void render_time(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    frame_put2(out, 0, tmv->tm_hour);
+    frame_put2(out, 2, tmv->tm_min);
+    out->dot[0] = LOW; out->dot[1] = blink_dot(tv);
+    out->dot[2] = LOW; out->dot[3] = LOW;
+}
+
+/* h:MM with blank leading zero, dot on the last tube = PM */
+static void render_time12(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    int h = tmv->tm_hour % 12;
+    if (h == 0) h = 12;
+    frame_put2(out, 0, h);
+    if (h < 10) out->digit[0] = GLYPH_BLANK;
+    frame_put2(out, 2, tmv->tm_min);
+    out->dot[0] = LOW; out->dot[1] = blink_dot(tv);
+    out->dot[2] = LOW; out->dot[3] = (tmv->tm_hour >= 12) ? HIGH : LOW;
+}
+
+/* DD.MM, all dots blinking */
+static void render_date(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    frame_put2(out, 0, tmv->tm_mday);
+    frame_put2(out, 2, tmv->tm_mon + 1);
+    uint8_t dot = blink_dot(tv);
+    for (int i = 0; i < 4; i++) out->dot[i] = dot;
+}
+
+/* MM.SS */
+static void render_seconds(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    frame_put2(out, 0, tmv->tm_min);
+    frame_put2(out, 2, tmv->tm_sec);
+    out->dot[0] = LOW; out->dot[1] = HIGH;
+    out->dot[2] = LOW; out->dot[3] = LOW;
+}
+
+/* YYYY */
+static void render_year(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    int y = tmv->tm_year + 1900;
+    frame_put2(out, 0, y / 100);
+    frame_put2(out, 2, y % 100);
+    for (int i = 0; i < 4; i++) out->dot[i] = LOW;
+}
+
+static void render_value(const display_state_t *st, const struct tm *tmv, const struct timeval *tv, frame_t *out)
+{
+    if (st->value) *out = *st->value;
+    else           render_none(st, tmv, tv, out);
+}
+
+void chrono_render(int64_t cs, bool flash_off, frame_t *out)
+{
+    if (flash_off) {
+        render_blank(NULL, NULL, NULL, out);
+        return;
+    }
+    for (int i = 0; i < 4; i++) out->dot[i] = LOW;
+    if (cs < 6000) {
+        frame_put2(out, 0, (int)(cs / 100));
+        frame_put2(out, 2, (int)(cs % 100));
+    } else if (cs < 600000) {
+        frame_put2(out, 0, (int)(cs / 6000));
+        frame_put2(out, 2, (int)(cs / 100 % 60));
+    } else {
+        frame_put2(out, 0, (int)(cs / 360000 % 100));
+        frame_put2(out, 2, (int)(cs / 6000 % 60));
+    }
+    out->dot[1] = HIGH;
+}
+
+/* PAGE_CHRONO is committed by chrono_tick() and never selected here */
+static const page_render_fn page_renders[PAGE_COUNT] = {
+    [PAGE_NONE]    = render_none,
+    [PAGE_BLANK]   = render_blank,
+    [PAGE_TIME]    = render_time,
+    [PAGE_TIME12]  = render_time12,
+    [PAGE_DATE]    = render_date,
+    [PAGE_SECONDS] = render_seconds,
+    [PAGE_YEAR]    = render_year,
+    [PAGE_VALUE]   = render_value,
+    [PAGE_CHRONO]  = render_none,
+};
+
+/* "none" and "chrono" are internal states (no time yet, /chrono) */
+static bool page_rotatable(int page)
+{
+    return page != PAGE_NONE && page != PAGE_CHRONO;
+}
+
+static int page_find(const char *name, size_t len)
+{
+    for (int i = 0; i < PAGE_COUNT; i++) {
+        if (strlen(page_names[i]) == len && strncmp(page_names[i], name, len) == 0) return i;
+    }
+    return -1;
+}
+
+bool rotation_parse(const char *spec, rotation_t *out)
+{
+    rotation_t r = { .base = PAGE_TIME };
+    bool have_base = false;
+
+    while (*spec) {
+        const char *end = strchr(spec, ',');
+        size_t len = end ? (size_t)(end - spec) : strlen(spec);
+        const char *at = memchr(spec, '@', len);
+
+        int page = page_find(spec, at ? (size_t)(at - spec) : len);
+        if (page < 0 || !page_rotatable(page)) return false;
+
+        if (!at) {
+            if (have_base) return false;
+            r.base = (uint8_t)page;
+            have_base = true;
+        } else {
+            unsigned start, dur;
+            char tail;
+            char tmp[16];
+            size_t n = len - (size_t)(at - spec) - 1;
+            if (n >= sizeof(tmp) || r.count >= ROTATION_MAX_SLOTS) return false;
+            memcpy(tmp, at + 1, n);
+            tmp[n] = '\0';
+            if (sscanf(tmp, "%u+%u%c", &start, &dur, &tail) != 2) return false;
+            if (start > 59 || dur < 1 || dur > 60) return false;
+            r.slots[r.count].page      = (uint8_t)page;
+            r.slots[r.count].start_sec = (uint8_t)start;
+            r.slots[r.count].len_sec   = (uint8_t)dur;
+            r.count++;
+        }
+        spec += len;
+        if (*spec == ',') spec++;
+    }
+
+    *out = r;
+    return true;
+}
+
+uint8_t rotation_page_for_second(const rotation_t *r, int sec)
+{
+    for (size_t i = 0; i < r->count; i++) {
+        int rel = (sec - r->slots[i].start_sec + 60) % 60;   // windows may wrap the minute
+        if (rel < r->slots[i].len_sec) return r->slots[i].page;
+    }
+    return r->base;
+}
+
+bool page_value_parse(const char *text, frame_t *out, bool *nonempty)
+{
+    frame_t f;
+    int n = 0;
+    for (const char *p = text; *p; p++) {
+        if (*p == '.') {
+            if (n == 0) return false;
+            f.dot[n - 1] = HIGH;
+            continue;
+        }
+        if (n >= 4) return false;
+        if (*p >= '0' && *p <= '9') f.digit[n] = (uint8_t)(*p - '0');
+        else if (*p == '-')         f.digit[n] = GLYPH_HYPHEN;
+        else if (*p == ' ')         f.digit[n] = GLYPH_BLANK;
+        else return false;
+        f.dot[n++] = LOW;
+    }
+
+    // Right-align shorter values
+    int pad = 4 - n;
+    for (int i = 0; i < 4; i++) {
+        out->digit[i] = (i < pad) ? GLYPH_BLANK : f.digit[i - pad];
+        out->dot[i]   = (i < pad) ? LOW         : f.dot[i - pad];
+    }
+    *nonempty = (n > 0);
+    return true;
+}
+
+uint8_t display_render(const display_state_t *st, const struct timeval *tv,
+                       const struct tm *tmv, frame_t *out)
+{
+    uint8_t page;
+    if (!st->time_set) {
+        page = PAGE_NONE;
+    } else if (tv->tv_sec < st->alarm_until) {
+        // Alarm: flash the time at 1 Hz, overrides blanking
+        page = (tv->tv_usec < 500000) ? st->rotation->base : PAGE_BLANK;
+    } else if (st->blank) {
+        page = PAGE_BLANK;
+    } else {
+        page = rotation_page_for_second(st->rotation, tmv->tm_sec);
+    }
+
+    page_renders[page](st, tmv, tv, out);
+    return page;
+}
@@ -0,0 +1,88 @@
+/* ------------------------------------------------------------
+   Display pages
+
+   Each page renders a complete 4-tube frame from the local time.
+   display_render() picks the page for one instant (no time yet,
+   alarm flash, night blanking, rotation within the minute) from
+   its arguments only: no clock reads, no globals. display_task in
+   main.c feeds it the real clock and commits the frame; the host
+   replay (Firmware/test/host/replay_display.c) feeds it a virtual
+   one.
+   ------------------------------------------------------------ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/time.h>
+
+#ifndef HIGH
+#define HIGH 1
+#endif
+#ifndef LOW
+#define LOW  0
+#endif
+
+#define GLYPH_HYPHEN 10
+#define GLYPH_BLANK  11
+
+typedef struct {
+    uint8_t digit[4];   // 0..9, GLYPH_HYPHEN, GLYPH_BLANK
+    uint8_t dot[4];     // HIGH/LOW
+} frame_t;
+
+typedef enum {
+    PAGE_NONE = 0,   // no time yet
+    PAGE_BLANK,
+    PAGE_TIME,
+    PAGE_TIME12,
+    PAGE_DATE,
+    PAGE_SECONDS,
+    PAGE_YEAR,
+    PAGE_VALUE,
+    PAGE_CHRONO,     // stopwatch / countdown, committed by chrono_tick()
+    PAGE_COUNT
+} page_id_t;
+
+#define ROTATION_MAX_SLOTS 6
+
+typedef struct {
+    uint8_t page;        // page_id_t
+    uint8_t start_sec;   // 0..59
+    uint8_t len_sec;     // 1..60
+} rotation_slot_t;
+
+typedef struct {
+    uint8_t         base;    // page outside all slots
+    rotation_slot_t slots[ROTATION_MAX_SLOTS];
+    size_t          count;
+} rotation_t;
+
+/* Everything besides the time that decides what the tubes show */
+typedef struct {
+    bool              time_set;
+    bool              blank;         // night blanking
+    time_t            alarm_until;   // flash the base page until then
+    const rotation_t *rotation;
+    const frame_t    *value;         // POST /api/value, NULL = none
+} display_state_t;
+
+extern const char *const page_names[PAGE_COUNT];
+
+/* Rotation spec: "base[,page@start+len]...", e.g. "time,date@50+5,year@55+2".
+   Only the pages offered on /config (time, time12, date, seconds,
+   year, value, blank). Returns false and leaves *out alone on error. */
+bool rotation_parse(const char *spec, rotation_t *out);
+uint8_t rotation_page_for_second(const rotation_t *r, int sec);
+
+/* "12.34", "-5", " 7.5": up to 4 tubes of digit/'-'/' ', each optionally
+   followed by '.', right-aligned. *nonempty is false for "". */
+bool page_value_parse(const char *text, frame_t *out, bool *nonempty);
+
+/* Stopwatch/countdown frame for cs hundredths: SS.cc below a minute,
+   MM.SS below 100 minutes, then HH.MM; flash_off blanks it (done) */
+void chrono_render(int64_t cs, bool flash_off, frame_t *out);
+
+uint8_t display_render(const display_state_t *st, const struct timeval *tv,
+                       const struct tm *tmv, frame_t *out);
@@ -0,0 +1,72 @@
+#include "form.h"
+
+static inline int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Decode [src, end) onto dst (dst <= src), returns decoded length */
+static size_t form_decode_span(char *dst, const char *src, const char *end)
+{
+    char *out = dst;
+    while (src < end) {
+        int hi, lo;
+        if (*src == '%' && end - src >= 3 &&
+            (hi = hex_nibble(src[1])) >= 0 && (lo = hex_nibble(src[2])) >= 0) {
+            *out++ = (char)((hi << 4) | lo);
+            src += 3;
+        } else if (*src == '+') {
+            *out++ = ' ';
+            src++;
+        } else {
+            *out++ = *src++;
+        }
+    }
+    return (size_t)(out - dst);
+}
+
+void form_iter_init(form_iter_t *it, char *buf, size_t len)
+{
+    it->cur = buf;
+    it->end = buf + len;
+    *it->end = '\0';
+}
+
+bool form_next(form_iter_t *it, form_field_t *f)
+{
+    while (it->cur < it->end) {
+        char *pair = it->cur;
+        char *amp = memchr(pair, '&', (size_t)(it->end - pair));
+        if (!amp) amp = it->end;
+        it->cur = (amp < it->end) ? amp + 1 : it->end;
+
+        if (amp == pair) continue;
+
+        char *eq = memchr(pair, '=', (size_t)(amp - pair));
+        char *key_end = eq ? eq : amp;
+        char *val     = eq ? eq + 1 : amp;
+
+        size_t key_len = form_decode_span(pair, pair, key_end);
+        pair[key_len] = '\0';
+        size_t val_len = form_decode_span(val, val, amp);
+        val[val_len] = '\0';
+
+        f->key = pair; f->key_len = key_len;
+        f->val = val;  f->val_len = val_len;
+        return true;
+    }
+    return false;
+}
+
+bool form_copy_val(char *dst, size_t dst_size, const form_field_t *f)
+{
+    if (f->val_len >= dst_size || memchr(f->val, '\0', f->val_len)) {
+        return false;
+    }
+    memcpy(dst, f->val, f->val_len);
+    dst[f->val_len] = '\0';
+    return true;
+}
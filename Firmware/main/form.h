@@ -0,0 +1,44 @@
+/* ------------------------------------------------------------
+   Form decoding (application/x-www-form-urlencoded)
+
+   Decodes in place: a decoded field is never longer than its
+   encoding, so key and value are rewritten inside the receive
+   buffer and NUL-terminated where the '=' / '&' separators were.
+   No field is copied and no output can overrun the input.
+
+   Plain C without ESP-IDF dependencies, so the same code is
+   fuzzed and benchmarked on the host (Firmware/test/host).
+   ------------------------------------------------------------ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    const char *key;
+    size_t      key_len;
+    const char *val;
+    size_t      val_len;
+} form_field_t;
+
+typedef struct {
+    char *cur;
+    char *end;
+} form_iter_t;
+
+/* buf must hold len + 1 bytes (room for the final terminator) */
+void form_iter_init(form_iter_t *it, char *buf, size_t len);
+
+/* Next key/value pair; false when the body is exhausted.
+   Pairs without '=' yield an empty value, empty pairs are skipped. */
+bool form_next(form_iter_t *it, form_field_t *f);
+
+/* Copy a value into a fixed field; false (and dst untouched) if it does not fit */
+bool form_copy_val(char *dst, size_t dst_size, const form_field_t *f);
+
+static inline bool form_key_is(const form_field_t *f, const char *key)
+{
+    size_t n = strlen(key);
+    return f->key_len == n && memcmp(f->key, key, n) == 0;
+}
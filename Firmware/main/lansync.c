@@ -0,0 +1,153 @@
+#include <string.h>
+#include "lansync.h"
+
+/* Byte order helpers, so this file does not depend on lwIP or libc sockets */
+static inline uint32_t be32(uint32_t v)
+{
+    const uint8_t *b = (const uint8_t *)&v;
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static inline uint32_t to_be32(uint32_t v)
+{
+    uint32_t out;
+    uint8_t *b = (uint8_t *)&out;
+    b[0] = (uint8_t)(v >> 24); b[1] = (uint8_t)(v >> 16);
+    b[2] = (uint8_t)(v >> 8);  b[3] = (uint8_t)v;
+    return out;
+}
+
+
+void lansync_init(lansync_state_t *st, uint32_t node_id, const lansync_clock_t *clk)
+{
+    memset(st, 0, sizeof(*st));
+    st->node_id        = node_id;
+    st->role           = LANSYNC_LISTEN;
+    st->last_beacon_us = clk->mono_us(clk->ctx);   // listen one timeout before claiming master
+}
+
+const char *lansync_role_str(lansync_role_t role)
+{
+    switch (role) {
+    case LANSYNC_LISTEN:   return "listening";
+    case LANSYNC_MASTER:   return "master";
+    case LANSYNC_FOLLOWER: return "follower";
+    default:               return "off";
+    }
+}
+
+void lansync_beacon(lansync_state_t *st, const lansync_clock_t *clk,
+                    const lansync_local_t *local, lansync_pkt_t *pkt)
+{
+    int64_t  wall = clk->wall_us(clk->ctx);
+    uint64_t sec  = (uint64_t)(wall / 1000000);
+
+    memset(pkt, 0, sizeof(*pkt));
+    pkt->magic   = to_be32(LANSYNC_MAGIC);
+    pkt->version = LANSYNC_VERSION;
+    pkt->synced  = local->time_valid ? 1 : 0;
+    pkt->node_id = to_be32(st->node_id);
+    pkt->sec_hi  = to_be32((uint32_t)(sec >> 32));
+    pkt->sec_lo  = to_be32((uint32_t)sec);
+    pkt->usec    = to_be32((uint32_t)(wall % 1000000));
+    st->beacons_tx++;
+}
+
+static unsigned claim_master(lansync_state_t *st, const lansync_clock_t *clk)
+{
+    if (st->role == LANSYNC_FOLLOWER) clk->own_source(clk->ctx, true);
+    st->role      = LANSYNC_MASTER;
+    st->master_id = st->node_id;
+    return LANSYNC_EV_CLAIMED;
+}
+
+static unsigned follow(lansync_state_t *st, const lansync_clock_t *clk,
+                       uint32_t id, int64_t offset)
+{
+    unsigned ev = LANSYNC_EV_BEACON;
+
+    if (st->role != LANSYNC_FOLLOWER || st->master_id != id) {
+        if (st->role == LANSYNC_MASTER) ev |= LANSYNC_EV_YIELDED;
+        // Keep our own source running while it could still make us master
+        clk->own_source(clk->ctx, st->node_id < id);
+        st->phase_err_us = lansync_clamp32(offset);
+        ev |= LANSYNC_EV_NEW_MASTER;
+    }
+    st->role           = LANSYNC_FOLLOWER;
+    st->master_id      = id;
+    st->last_beacon_us = clk->mono_us(clk->ctx);
+    st->offset_us      = lansync_clamp32(offset);
+
+    if (offset > LANSYNC_STEP_US || offset < -LANSYNC_STEP_US) {
+        // Far off (or never set): step onto master time
+        clk->step(clk->ctx, offset);
+        st->steps++;
+        st->phase_err_us = 0;
+        return ev | LANSYNC_EV_STEPPED;
+    }
+
+    st->phase_err_us += (st->offset_us - st->phase_err_us) / 4;
+
+    if (offset > LANSYNC_DEADBAND_US || offset < -LANSYNC_DEADBAND_US) {
+        if (clk->slew(clk->ctx, (int32_t)offset)) st->slews++;
+    }
+    return ev;
+}
+
+unsigned lansync_on_packet(lansync_state_t *st, const lansync_clock_t *clk,
+                           const lansync_local_t *local,
+                           const void *data, int len, int64_t rx_wall_us)
+{
+    lansync_pkt_t pkt;
+    if (len != (int)sizeof(pkt)) return 0;
+    memcpy(&pkt, data, sizeof(pkt));
+    if (be32(pkt.magic) != LANSYNC_MAGIC || pkt.version != LANSYNC_VERSION) return 0;
+
+    uint32_t id = be32(pkt.node_id);
+    if (id == st->node_id || !pkt.synced) return 0;
+
+    st->beacons_rx++;
+
+    bool lower_than_sender = local->has_source && st->node_id < id;
+
+    switch (st->role) {
+    case LANSYNC_MASTER:
+        if (local->time_valid && id > st->node_id) return 0;   // we win the election
+        break;
+    case LANSYNC_FOLLOWER:
+        if (id == st->master_id) break;
+        if (id > st->master_id) return 0;                      // stay with the lower master
+        break;
+    case LANSYNC_LISTEN:
+        // We would win: take over instead of following, the sender yields
+        if (lower_than_sender) return claim_master(st, clk);
+        break;
+    default:
+        return 0;
+    }
+
+    int64_t master_us = (int64_t)(((uint64_t)be32(pkt.sec_hi) << 32) | be32(pkt.sec_lo)) * 1000000LL
+                      + be32(pkt.usec);
+    return follow(st, clk, id, master_us - rx_wall_us);
+}
+
+unsigned lansync_on_second(lansync_state_t *st, const lansync_clock_t *clk,
+                           const lansync_local_t *local)
+{
+    unsigned ev = 0;
+    bool master_lost = (clk->mono_us(clk->ctx) - st->last_beacon_us) > LANSYNC_MASTER_TIMEOUT;
+
+    if (st->role == LANSYNC_FOLLOWER && master_lost) {
+        st->role = LANSYNC_LISTEN;
+        clk->own_source(clk->ctx, true);
+        ev |= LANSYNC_EV_MASTER_LOST;
+    } else if (st->role == LANSYNC_FOLLOWER && local->has_source && st->node_id < st->master_id) {
+        // Got our own source while following a higher id: lead instead
+        ev |= claim_master(st, clk);
+    } else if (st->role == LANSYNC_LISTEN && master_lost && local->time_valid) {
+        ev |= claim_master(st, clk);
+    }
+
+    if (st->role == LANSYNC_MASTER) ev |= LANSYNC_EV_SEND_BEACON;
+    return ev;
+}
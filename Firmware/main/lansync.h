@@ -0,0 +1,110 @@
+/* ------------------------------------------------------------
+   LAN time sync (protocol and state machine)
+
+   Optional. Every clock with LAN sync enabled listens on a UDP
+   port; the clock with the lowest node id (from the STA MAC)
+   among those with their own time source (SNTP) becomes master
+   and broadcasts its wall time right after each second boundary.
+   Followers stop SNTP and slew (or, if far off, step) their clock
+   onto the master, so seconds, minute rollover and colon blink
+   line up across the room. A clock with its own source and a
+   lower id than the current master claims the role instead of
+   following (a lower id without a source follows but keeps SNTP
+   running until it answers); the master steps down when it hears
+   it. If the master goes quiet, followers fall back to SNTP and
+   the next lowest id takes over.
+
+   Socket I/O and the clock are supplied by the caller
+   (lansync_task in main.c, the loopback test on the host).
+   ------------------------------------------------------------ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LANSYNC_PORT            12321
+#define LANSYNC_MAGIC           0x49563353u   // "IV3S"
+#define LANSYNC_VERSION         1
+#define LANSYNC_MASTER_TIMEOUT  3500000LL     // us without beacon => master lost
+#define LANSYNC_STEP_US         100000        // step above 100 ms, slew below
+#define LANSYNC_DEADBAND_US     500           // ignore offsets below 0.5 ms
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  synced;        // sender has a valid time
+    uint16_t reserved;
+    uint32_t node_id;
+    uint32_t sec_hi;
+    uint32_t sec_lo;
+    uint32_t usec;
+} lansync_pkt_t;           // all fields in network byte order
+
+typedef enum {
+    LANSYNC_OFF = 0,
+    LANSYNC_LISTEN,
+    LANSYNC_MASTER,
+    LANSYNC_FOLLOWER,
+} lansync_role_t;
+
+typedef struct {
+    volatile lansync_role_t role;
+    uint32_t node_id;
+    volatile uint32_t master_id;
+    volatile int64_t  last_beacon_us;   // monotonic time of last master beacon
+    volatile int32_t  offset_us;        // last raw offset master - local
+    volatile int32_t  phase_err_us;     // filtered offset
+    volatile uint32_t beacons_tx;
+    volatile uint32_t beacons_rx;
+    volatile uint32_t steps;
+    volatile uint32_t slews;
+} lansync_state_t;
+
+/* What the state machine needs from the platform */
+typedef struct {
+    int64_t (*mono_us)(void *ctx);                 // monotonic, us
+    int64_t (*wall_us)(void *ctx);                 // wall clock, us since epoch
+    void    (*step)(void *ctx, int64_t delta_us);  // jump the wall clock
+    bool    (*slew)(void *ctx, int32_t delta_us);  // adjtime()-style correction
+    void    (*own_source)(void *ctx, bool on);     // SNTP on (leader/alone) or off (following)
+    void     *ctx;
+} lansync_clock_t;
+
+/* Local time status, passed on every call */
+typedef struct {
+    bool time_valid;    // wall clock holds a real time (from anywhere)
+    bool has_source;    // own time source (SNTP) has answered
+} lansync_local_t;
+
+/* Events returned by the handlers (bit mask), for logging */
+#define LANSYNC_EV_BEACON       0x01   // beacon of our master applied
+#define LANSYNC_EV_NEW_MASTER   0x02   // started following master_id
+#define LANSYNC_EV_STEPPED      0x04   // wall clock was stepped
+#define LANSYNC_EV_YIELDED      0x08   // was master, lower id took over
+#define LANSYNC_EV_CLAIMED      0x10   // became master
+#define LANSYNC_EV_MASTER_LOST  0x20   // master quiet, back to own source
+#define LANSYNC_EV_SEND_BEACON  0x40   // caller should broadcast lansync_beacon() now
+
+/* Saturate a microsecond offset to the 32-bit fields above */
+static inline int32_t lansync_clamp32(int64_t v)
+{
+    if (v > INT32_MAX) return INT32_MAX;
+    if (v < INT32_MIN) return INT32_MIN;
+    return (int32_t)v;
+}
+
+void        lansync_init(lansync_state_t *st, uint32_t node_id, const lansync_clock_t *clk);
+const char *lansync_role_str(lansync_role_t role);
+
+/* Fill a beacon for the current wall time */
+void lansync_beacon(lansync_state_t *st, const lansync_clock_t *clk,
+                    const lansync_local_t *local, lansync_pkt_t *pkt);
+
+/* A packet of len bytes arrived; rx_wall_us is the wall time at reception */
+unsigned lansync_on_packet(lansync_state_t *st, const lansync_clock_t *clk,
+                           const lansync_local_t *local,
+                           const void *pkt, int len, int64_t rx_wall_us);
+
+/* Call right after each wall-clock second boundary */
+unsigned lansync_on_second(lansync_state_t *st, const lansync_clock_t *clk,
+                           const lansync_local_t *local);
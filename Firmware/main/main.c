@@ -4,13 +4,15 @@
 #include <stdbool.h>
 #include <time.h>
 #include <sys/time.h>
-#include <ctype.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <inttypes.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
 
 #include "driver/gpio.h"
 #include "driver/gptimer.h"
@@ -19,6 +21,9 @@
 #include "esp_log.h"
 #include "esp_rom_sys.h"
 #include "esp_err.h"
+#include "esp_mac.h"
+#include "esp_heap_caps.h"
+#include "esp_app_desc.h"
 
 #include "soc/gpio_struct.h"
 #include "soc/gpio_reg.h"
@@ -32,8 +37,17 @@
 #include "esp_sntp.h"
 
 #include "esp_http_server.h"
+#include "esp_console.h"
 
 #include "lwip/ip4_addr.h"
+#include "lwip/sockets.h"
+
+#include "form.h"
+#include "lansync.h"
+#include "sched.h"
+#include "display_pages.h"
+#include "mux_scan.h"
+#include "tz_options.h"
 
 static const char *TAG = "IV3_CLOCK";
 
@@ -69,7 +83,7 @@ static const char *TAG = "IV3_CLOCK";
     Digit segment 
     Order: [A,B,C,D,E,F,G]
    ------------------------------------------------------------ */
-static const uint8_t digit_seg_data[11][7] = {
+static const DRAM_ATTR uint8_t digit_seg_data[12][7] = {
     {HIGH, HIGH, HIGH, HIGH, HIGH, HIGH,  LOW},  // 0
     { LOW, HIGH, HIGH,  LOW,  LOW,  LOW,  LOW},  // 1
     {HIGH, HIGH,  LOW, HIGH, HIGH,  LOW, HIGH},  // 2
@@ -80,11 +94,12 @@ static const uint8_t digit_seg_data[11][7] = {
     {HIGH, HIGH, HIGH,  LOW,  LOW,  LOW,  LOW},  // 7
     {HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH},  // 8
     {HIGH, HIGH, HIGH, HIGH,  LOW, HIGH, HIGH},  // 9
-    { LOW,  LOW,  LOW,  LOW,  LOW,  LOW, HIGH}   // Hyphen
+    { LOW,  LOW,  LOW,  LOW,  LOW,  LOW, HIGH},  // Hyphen
+    { LOW,  LOW,  LOW,  LOW,  LOW,  LOW,  LOW}   // Blank
 };
 
 typedef struct {
-    uint8_t digit;  // 0..9, 10=hyphen
+    uint8_t digit;  // 0..9, 10=hyphen, 11=blank
     uint8_t dot;    // HIGH/LOW
 } TUBE;
 
@@ -97,25 +112,47 @@ static volatile TUBE tube_list[4] = {
 };
 
 /* ISR-Vars */
-static volatile uint8_t cur_tube     = 3;
-static volatile uint8_t tube_toggle  = 0;
+static TUBE isr_frame[4] = {
+    {10, LOW}, {10, LOW}, {10, LOW}, {10, LOW},
+};
+static DRAM_ATTR mux_scan_t s_mux_scan = MUX_SCAN_INIT;
+static volatile uint32_t s_frame_seq = 0;  // bumped by frame_commit() with each new frame
 static volatile uint8_t led_pwm_step = 0;  // 0..7
-static volatile uint8_t led_pwm_off  = 2;  // 0..8 (8=always on)
+#define LED_PWM_DEFAULT 2
+static volatile uint8_t led_pwm_off  = LED_PWM_DEFAULT;  // 0..8 (8=always on)
 
 static portMUX_TYPE tube_mux = portMUX_INITIALIZER_UNLOCKED;
 
-static const int seg_pins[7] = {
+/* Pin tables and glyphs are read by the ISR, which also runs while
+   the flash cache is disabled (CONFIG_GPTIMER_ISR_CACHE_SAFE): DRAM */
+static const DRAM_ATTR int seg_pins[7] = {
     PIN_SEG_A, PIN_SEG_B, PIN_SEG_C, PIN_SEG_D,
     PIN_SEG_E, PIN_SEG_F, PIN_SEG_G
 };
 
-static const int grid_pins[4] = {
+static const DRAM_ATTR int grid_pins[4] = {
     PIN_GRID0, PIN_GRID1, PIN_GRID2, PIN_GRID3
 };
 
+/* Multiplex health, written by the alarm ISR, checked by mux_monitor() */
+typedef struct {
+    volatile uint32_t last_alarm_us; // low 32 bits of esp_timer time (atomic, wraps safely)
+    volatile uint32_t alarms;
+    volatile uint32_t late;          // alarm more than 1.5 periods after the previous one
+    volatile uint32_t missed;        // whole periods skipped
+    volatile uint32_t max_gap_us;
+    volatile uint32_t tube_scans[4]; // grid activations per tube
+} mux_health_t;
+
+static DRAM_ATTR mux_health_t s_mux_health;
+
 /* Time set? */
 static volatile bool time_set = false;
 
+/* Set by the scheduler */
+static volatile bool   s_display_blank = false;  // night blanking
+static volatile time_t s_alarm_until   = 0;      // flash display until this time
+
 /* ------------------------------------------------------------
    IRAM-safe GPIO setting in ISR (no gpio_set_level())
    ------------------------------------------------------------ */
@@ -132,7 +169,7 @@ static inline void IRAM_ATTR gpio_set_level_isr(int pin, int level)
 }
 
 /* ------------------------------------------------------------
-   Tube drive ISR @250 Hz
+   Tube drive ISR @500 Hz (one tube per alarm, 125 Hz per scan)
    ------------------------------------------------------------ */
 static void IRAM_ATTR isr_tubes(void)
 {
@@ -143,22 +180,30 @@ static void IRAM_ATTR isr_tubes(void)
 
     esp_rom_delay_us(40);
 
-    // Next tube
-    cur_tube = (cur_tube + 1) & 0x03;
+    // Next tube; latch all four at the start of a scan so one
+    // pass over the tubes never mixes two frames
+    if (mux_scan_next(&s_mux_scan)) {
+        portENTER_CRITICAL_ISR(&tube_mux);
+        for (int i = 0; i < 4; i++) {
+            isr_frame[i].digit = tube_list[i].digit;
+            isr_frame[i].dot   = tube_list[i].dot;
+        }
+        mux_scan_latch(&s_mux_scan, s_frame_seq);
+        portEXIT_CRITICAL_ISR(&tube_mux);
+    }
 
-    uint8_t digit, dot;
-    portENTER_CRITICAL_ISR(&tube_mux);
-    digit = tube_list[cur_tube].digit;
-    dot   = tube_list[cur_tube].dot;
-    portEXIT_CRITICAL_ISR(&tube_mux);
+    uint8_t tube  = s_mux_scan.cur_tube;
+    uint8_t digit = isr_frame[tube].digit;
+    uint8_t dot   = isr_frame[tube].dot;
 
-    if (digit > 10) digit = 10;
+    if (digit > GLYPH_BLANK) digit = GLYPH_HYPHEN;
     const uint8_t *seg = digit_seg_data[digit];
 
     for (int i = 0; i < 7; i++) gpio_set_level_isr(seg_pins[i], seg[i]);
     gpio_set_level_isr(PIN_DOT, dot);
 
-    gpio_set_level_isr(grid_pins[cur_tube], 1);
+    gpio_set_level_isr(grid_pins[tube], 1);
+    s_mux_health.tube_scans[tube]++;
 }
 
 /* ------------------------------------------------------------
@@ -188,9 +233,19 @@ static bool IRAM_ATTR timer_on_alarm(gptimer_handle_t timer,
                                      const gptimer_alarm_event_data_t *edata,
                                      void *user_ctx)
 {
-    tube_toggle ^= 1;
-    if (tube_toggle) isr_tubes();  // 250 Hz effective
-    isr_leds();                    // 500 Hz
+    uint32_t now  = (uint32_t)esp_timer_get_time();
+    uint32_t last = s_mux_health.last_alarm_us;
+    if (s_mux_health.alarms) {
+        uint32_t gap = now - last;
+        if (gap > MUX_PERIOD_US * 3 / 2) s_mux_health.late++;
+        if (gap >= MUX_PERIOD_US * 2)    s_mux_health.missed += gap / MUX_PERIOD_US - 1;
+        if (gap > s_mux_health.max_gap_us) s_mux_health.max_gap_us = gap;
+    }
+    s_mux_health.last_alarm_us = now;
+    s_mux_health.alarms++;
+
+    isr_tubes();   // one tube per alarm, full scan every MUX_SCAN_US
+    isr_leds();    // 500 Hz
 
     return false;
 }
@@ -222,6 +277,8 @@ static void init_gpios(void)
 /* ------------------------------------------------------------
    GPTimer init @500 Hz
    ------------------------------------------------------------ */
+static gptimer_handle_t s_gptimer = NULL;
+
 static void init_timer_500hz(void)
 {
     gptimer_handle_t gptimer = NULL;
@@ -246,75 +303,630 @@ static void init_timer_500hz(void)
     };
     ESP_ERROR_CHECK(gptimer_set_alarm_action(gptimer, &alarm_conf));
     ESP_ERROR_CHECK(gptimer_start(gptimer));
+    s_gptimer = gptimer;
 }
 
 /* ------------------------------------------------------------
-   Display functions
+   Multiplex health monitor
+
+   Runs every 10 ms from esp_timer. If no alarm arrived for
+   MUX_STALL_US, one grid may be stuck on and overdriven: all
+   grids and segments are switched off and the GPTimer is
+   restarted. Each tube must also keep getting its share of
+   scans. Incidents are counted and the last few are kept for
+   /api/status.
    ------------------------------------------------------------ */
-static void no_time(void)
+
+#define MUX_MONITOR_US      10000
+#define MUX_STALL_US        (5 * MUX_PERIOD_US)
+#define MUX_TUBE_WINDOW_US  200000    // per-tube progress window
+#define MUX_INCIDENTS       8
+
+typedef enum {
+    MUX_INC_STALL = 0,   // no alarm for MUX_STALL_US, timer restarted
+    MUX_INC_TUBE,        // one tube fell behind the others
+} mux_incident_type_t;
+
+typedef struct {
+    int64_t  at_us;      // esp_timer time
+    uint8_t  type;       // mux_incident_type_t
+    uint8_t  tube;
+    uint32_t gap_us;
+} mux_incident_t;
+
+static mux_incident_t     s_mux_incidents[MUX_INCIDENTS];
+static uint32_t           s_mux_incident_count = 0;   // total, ring index = count % MUX_INCIDENTS
+static uint32_t           s_mux_stalls   = 0;
+static uint32_t           s_mux_restarts = 0;
+static uint32_t           s_mux_tube_faults = 0;
+static portMUX_TYPE       mux_health_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_mux_monitor_timer = NULL;
+
+static const char *const mux_incident_names[] = { "stall", "tube" };
+
+static void mux_record(mux_incident_type_t type, uint8_t tube, uint32_t gap_us)
 {
-    portENTER_CRITICAL(&tube_mux);
+    portENTER_CRITICAL(&mux_health_mux);
+    mux_incident_t *inc = &s_mux_incidents[s_mux_incident_count % MUX_INCIDENTS];
+    inc->at_us  = esp_timer_get_time();
+    inc->type   = (uint8_t)type;
+    inc->tube   = tube;
+    inc->gap_us = gap_us;
+    s_mux_incident_count++;
+    portEXIT_CRITICAL(&mux_health_mux);
+}
+
+static void mux_grids_off(void)
+{
+    for (int i = 0; i < 4; i++) gpio_set_level_isr(grid_pins[i], 0);
+    for (int i = 0; i < 7; i++) gpio_set_level_isr(seg_pins[i], 0);
+    gpio_set_level_isr(PIN_DOT, 0);
+}
+
+static void mux_monitor(void *arg)
+{
+    static int64_t  window_start = 0;
+    static uint32_t window_scans[4];
+    static uint32_t window_alarms;
+
+    // Sample the ISR's stamp before the clock: read the other way round,
+    // an alarm landing in between makes the stamp newer than 'now' and
+    // the unsigned difference looks like a 71-minute stall.
+    uint32_t last = s_mux_health.last_alarm_us;
+    int64_t  now  = esp_timer_get_time();
+    uint32_t gap  = (uint32_t)now - last;
+
+    if ((int32_t)gap > MUX_STALL_US) {
+        mux_grids_off();
+        s_mux_stalls++;
+
+        gptimer_stop(s_gptimer);
+        gptimer_set_raw_count(s_gptimer, 0);
+        if (gptimer_start(s_gptimer) == ESP_OK) s_mux_restarts++;
+
+        // Count the gap once, not again on every monitor tick
+        s_mux_health.last_alarm_us = (uint32_t)now;
+        mux_record(MUX_INC_STALL, s_mux_scan.cur_tube, gap);
+        ESP_LOGW(TAG, "Multiplex: kein Alarm seit %" PRIu32 " us, Grids aus, Timer neu gestartet", gap);
+        window_start = 0;
+        return;
+    }
+
+    if (window_start == 0) {
+        window_start  = now;
+        window_alarms = s_mux_health.alarms;
+        for (int i = 0; i < 4; i++) window_scans[i] = s_mux_health.tube_scans[i];
+        return;
+    }
+    if (now - window_start < MUX_TUBE_WINDOW_US) return;
+
+    // 200 ms at 500 Hz = 100 alarms, 25 per tube; flag a tube below half that
+    uint32_t alarms = s_mux_health.alarms - window_alarms;
     for (int i = 0; i < 4; i++) {
-        tube_list[i].digit = 10; // Hyphen
-        tube_list[i].dot   = LOW;
+        uint32_t scans = s_mux_health.tube_scans[i] - window_scans[i];
+        if (alarms >= 80 && scans < alarms / (2 * MUX_TUBES)) {
+            s_mux_tube_faults++;
+            mux_grids_off();
+            mux_record(MUX_INC_TUBE, (uint8_t)i, 0);
+        }
     }
-    portEXIT_CRITICAL(&tube_mux);
+    window_start = 0;
 }
 
-static void display_time(void)
+static void mux_monitor_start(void)
 {
-    time_t t = time(NULL);
-    struct tm tmv;
-    localtime_r(&t, &tmv);   // Local time (time zone via TZ/TZSET)
+    const esp_timer_create_args_t args = {
+        .callback        = mux_monitor,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name            = "mux_monitor",
+    };
+    s_mux_health.last_alarm_us = (uint32_t)esp_timer_get_time();
+    ESP_ERROR_CHECK(esp_timer_create(&args, &s_mux_monitor_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(s_mux_monitor_timer, MUX_MONITOR_US));
+}
 
-    uint32_t ms = (uint32_t)((esp_timer_get_time() / 1000) % 1000);
-    uint8_t dot = (ms < 500) ? HIGH : LOW;
+/* ------------------------------------------------------------
+   Memory budget
 
-    portENTER_CRITICAL(&tube_mux);
+   Tasks and the HTML page buffer go through these helpers, so
+   /api/mem can report stack high-water marks and page peaks next
+   to the heap figures. With CONFIG_IV3_STATIC_ALLOC all of them
+   live in .bss instead of the heap; size them in menuconfig from
+   the peaks /api/mem reports plus some margin.
+   ------------------------------------------------------------ */
 
-    uint8_t u = (uint8_t)tmv.tm_sec;
-    if (u >= 50 && u <= 54) {
-        // show DD.MM
-        u = (uint8_t)tmv.tm_mday;
-        tube_list[1].digit = u % 10; tube_list[1].dot = dot;
-        tube_list[0].digit = u / 10; tube_list[0].dot = dot;
+#define MEM_MAX_TASKS 12
 
-        u = (uint8_t)(tmv.tm_mon + 1);
-        tube_list[3].digit = u % 10; tube_list[3].dot = dot;
-        tube_list[2].digit = u / 10; tube_list[2].dot = dot;
-    } else {
-        // show HH:MM
-        u = (uint8_t)tmv.tm_hour;
-        tube_list[1].digit = u % 10; tube_list[1].dot = dot;
-        tube_list[0].digit = u / 10; tube_list[0].dot = LOW;
+typedef struct {
+    const char   *name;
+    TaskHandle_t  handle;
+    uint32_t      stack_size;   // bytes
+} mem_task_t;
+
+static mem_task_t   s_mem_tasks[MEM_MAX_TASKS];
+static size_t       s_mem_task_count = 0;
+static portMUX_TYPE s_mem_mux = portMUX_INITIALIZER_UNLOCKED;  // guards s_mem_tasks
+static SemaphoreHandle_t s_mem_lock = NULL;  // held while /api/mem scans the stacks
+static size_t     s_html_peak = 0;  // longest page rendered so far (bytes)
+static uint32_t   s_html_truncated = 0;
+
+static void mem_register_task(const char *name, TaskHandle_t handle, uint32_t stack_size)
+{
+    if (!handle) return;
+    portENTER_CRITICAL(&s_mem_mux);
+    if (s_mem_task_count < MEM_MAX_TASKS) {
+        s_mem_tasks[s_mem_task_count].name       = name;
+        s_mem_tasks[s_mem_task_count].handle     = handle;
+        s_mem_tasks[s_mem_task_count].stack_size = stack_size;
+        s_mem_task_count++;
+    }
+    portEXIT_CRITICAL(&s_mem_mux);
+}
+
+static void mem_unregister_task(TaskHandle_t handle)
+{
+    portENTER_CRITICAL(&s_mem_mux);
+    for (size_t i = 0; i < s_mem_task_count; i++) {
+        if (s_mem_tasks[i].handle == handle) {
+            s_mem_tasks[i] = s_mem_tasks[--s_mem_task_count];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_mem_mux);
+}
+
+/* Tasks that give up (socket/bind failure) end through here. A scan
+   in progress is waited out before the task leaves the list, so
+   /api/mem never queries the stack of a deleted task. */
+static void mem_task_exit(void)
+{
+    xSemaphoreTake(s_mem_lock, portMAX_DELAY);
+    mem_unregister_task(xTaskGetCurrentTaskHandle());
+    xSemaphoreGive(s_mem_lock);
+    vTaskDelete(NULL);
+}
+
+/* stack/tcb are only used (and must be provided) in static mode */
+static TaskHandle_t mem_task_create(TaskFunction_t fn, const char *name, uint32_t stack_size,
+                                    void *arg, UBaseType_t prio,
+                                    StackType_t *stack, StaticTask_t *tcb)
+{
+    TaskHandle_t h = NULL;
+#ifdef CONFIG_IV3_STATIC_ALLOC
+    h = xTaskCreateStatic(fn, name, stack_size, arg, prio, stack, tcb);
+#else
+    (void)stack;
+    (void)tcb;
+    xTaskCreate(fn, name, stack_size, arg, prio, &h);
+#endif
+    mem_register_task(name, h, stack_size);
+    return h;
+}
+
+#ifdef CONFIG_IV3_STATIC_ALLOC
+#define MEM_TASK_CREATE(fn, name, stack_size, prio)                              \
+    do {                                                                         \
+        static StackType_t  fn##_stack[stack_size];                              \
+        static StaticTask_t fn##_tcb;                                            \
+        mem_task_create(fn, name, stack_size, NULL, prio, fn##_stack, &fn##_tcb); \
+    } while (0)
+#else
+#define MEM_TASK_CREATE(fn, name, stack_size, prio)                              \
+    mem_task_create(fn, name, stack_size, NULL, prio, NULL, NULL)
+#endif
+
+/* Mutexes that live as long as the firmware follow the same rule */
+#ifdef CONFIG_IV3_STATIC_ALLOC
+#define MEM_MUTEX_CREATE(handle)                                                 \
+    do {                                                                         \
+        static StaticSemaphore_t handle##_buf;                                   \
+        handle = xSemaphoreCreateMutexStatic(&handle##_buf);                     \
+    } while (0)
+#else
+#define MEM_MUTEX_CREATE(handle) ((handle) = xSemaphoreCreateMutex())
+#endif
+
+/* HTML page buffer. Pages render on the httpd task and the HTTP
+   workers, so in static mode the single buffer is handed out
+   under a mutex. */
+#ifdef CONFIG_IV3_STATIC_ALLOC
+static char              s_html_buf[CONFIG_IV3_HTML_BUF_SIZE];
+static StaticSemaphore_t s_html_lock_buf;
+static SemaphoreHandle_t s_html_lock;
 
-        u = (uint8_t)tmv.tm_min;
-        tube_list[3].digit = u % 10; tube_list[3].dot = LOW;
-        tube_list[2].digit = u / 10; tube_list[2].dot = LOW;
+static char *html_buf_alloc(void)
+{
+    xSemaphoreTake(s_html_lock, portMAX_DELAY);
+    return s_html_buf;
+}
+static void html_buf_free(char *buf) { if (buf) xSemaphoreGive(s_html_lock); }
+#else
+static char *html_buf_alloc(void) { return malloc(CONFIG_IV3_HTML_BUF_SIZE); }
+static void  html_buf_free(char *buf) { free(buf); }
+#endif
+
+static void mem_init(void)
+{
+#ifdef CONFIG_IV3_STATIC_ALLOC
+    s_html_lock = xSemaphoreCreateMutexStatic(&s_html_lock_buf);
+#endif
+    MEM_MUTEX_CREATE(s_mem_lock);
+}
+
+/* Record the length snprintf wanted for a page */
+static void html_buf_note(int written)
+{
+    if (written < 0) return;
+    if ((size_t)written > s_html_peak) s_html_peak = (size_t)written;
+    if ((size_t)written >= CONFIG_IV3_HTML_BUF_SIZE) {
+        s_html_truncated++;
+        ESP_LOGW(TAG, "HTML-Seite abgeschnitten (%d > %d Bytes)", written, CONFIG_IV3_HTML_BUF_SIZE);
+    }
+}
+
+/* Append to a page in the HTML buffer piece by piece, instead of
+   staging the pieces on the stack. *off counts the length wanted,
+   like snprintf's return value, for html_buf_note(). */
+static void html_buf_printf(char *html, size_t *off, const char *fmt, ...)
+{
+    size_t room = *off < CONFIG_IV3_HTML_BUF_SIZE ? CONFIG_IV3_HTML_BUF_SIZE - *off : 0;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(room ? html + *off : NULL, room, fmt, ap);
+    va_end(ap);
+    if (n > 0) *off += (size_t)n;
+}
+
+/* ------------------------------------------------------------
+   Display pages (rendering in display_pages.c)
+
+   display_task reads the clock and the page state below, lets
+   display_render() pick and render the page for this moment and
+   commits the frame to tube_list only if a glyph or dot differs
+   from what is shown, all four tubes in one critical section.
+   ------------------------------------------------------------ */
+
+static volatile uint32_t s_page_commits[PAGE_COUNT];   // frames actually written to the tubes
+
+static rotation_t s_rotation = {   // tube_mux; display_task works on a copy
+    .base  = PAGE_TIME,
+    .slots = { { PAGE_DATE, 50, 5 } },   // DD.MM between 50 and 54 seconds
+    .count = 1,
+};
+
+/* Externally supplied value (POST /api/value) */
+static frame_t         s_value_frame;
+static bool            s_value_valid = false;
+
+/* Stopwatch / countdown state, see chrono_command() */
+typedef enum {
+    CHRONO_OFF = 0,
+    CHRONO_STOPWATCH,
+    CHRONO_COUNTDOWN,
+} chrono_mode_t;
+
+#define CHRONO_TICK_US     10000      // 100 Hz
+#define CHRONO_DONE_FLASH  30000000LL // flash 00.00 for 30 s, then back to the clock
+
+typedef struct {
+    volatile chrono_mode_t mode;
+    bool     running;
+    int64_t  base_us;      // esp_timer time of the last start
+    int64_t  acc_us;       // elapsed before the last start
+    int64_t  total_us;     // countdown length
+    int64_t  done_us;      // countdown reached zero (0 = not yet)
+    int64_t  last_cs;      // last rendered hundredth, -1 = none
+    volatile uint32_t skipped;   // hundredths never rendered
+    uint32_t latched_base; // s_mux_scan counters when the chrono was last (re)set
+    uint32_t dropped_base;
+} chrono_t;
+
+static chrono_t     s_chrono = { .mode = CHRONO_OFF, .last_cs = -1 };
+static portMUX_TYPE chrono_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const chrono_mode_names[] = { "off", "stopwatch", "countdown" };
+
+/* Shown value in us (elapsed, or remaining for a countdown); chrono_mux held */
+static int64_t chrono_value_us(int64_t now)
+{
+    int64_t elapsed = s_chrono.acc_us + (s_chrono.running ? now - s_chrono.base_us : 0);
+    if (s_chrono.mode != CHRONO_COUNTDOWN) return elapsed;
+    int64_t left = s_chrono.total_us - elapsed;
+    return left > 0 ? left : 0;
+}
+
+static void render_chrono(frame_t *out)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&chrono_mux);
+    int64_t us   = chrono_value_us(now);
+    bool counting_down = (s_chrono.mode == CHRONO_COUNTDOWN);
+    int64_t done = s_chrono.done_us;
+
+    // Count down in whole hundredths remaining, so 00.00 means done
+    int64_t cs = counting_down ? (us + CHRONO_TICK_US - 1) / CHRONO_TICK_US : us / CHRONO_TICK_US;
+
+    // Same lock as chrono_command(), which resets both
+    if (s_chrono.last_cs >= 0) {
+        int64_t step = counting_down ? s_chrono.last_cs - cs : cs - s_chrono.last_cs;
+        if (step > 1) s_chrono.skipped += (uint32_t)(step - 1);
     }
+    s_chrono.last_cs = cs;
+    portEXIT_CRITICAL(&chrono_mux);
+
+    chrono_render(cs, done && ((now - done) / 250000) & 1, out);
+}
+
+/* Rotation from /config or NVS; false leaves the active one alone */
+static bool page_rotation_parse(const char *spec)
+{
+    // Parse into a copy; display_task copies the table under the same lock
+    rotation_t r;
+    if (!rotation_parse(spec, &r)) return false;
+
+    portENTER_CRITICAL(&tube_mux);
+    s_rotation = r;
+    portEXIT_CRITICAL(&tube_mux);
+    return true;
+}
+
+static bool page_value_set(const char *text)
+{
+    frame_t f;
+    bool nonempty;
+    if (!page_value_parse(text, &f, &nonempty)) return false;
+
+    portENTER_CRITICAL(&tube_mux);
+    s_value_frame = f;
+    s_value_valid = nonempty;
+    portEXIT_CRITICAL(&tube_mux);
+    return true;
+}
+
+/* Write frame to the tubes if it differs from the last one.
+   Called from display_task and from chrono_tick(). */
+static bool frame_commit(const frame_t *f)
+{
+    bool changed = false;
 
+    portENTER_CRITICAL(&tube_mux);
+    for (int i = 0; i < 4; i++) {
+        if (tube_list[i].digit != f->digit[i] || tube_list[i].dot != f->dot[i]) {
+            changed = true;
+            break;
+        }
+    }
+    if (changed) {
+        for (int i = 0; i < 4; i++) {
+            tube_list[i].digit = f->digit[i];
+            tube_list[i].dot   = f->dot[i];
+        }
+        s_frame_seq++;
+    }
     portEXIT_CRITICAL(&tube_mux);
+
+    return changed;
 }
 
 static void display_task(void *arg)
 {
     while (1) {
-        if (!time_set) no_time();
-        else           display_time();
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        struct tm tmv;
+        localtime_r(&tv.tv_sec, &tmv);   // Local time (time zone via TZ/TZSET)
+
+        if (s_chrono.mode != CHRONO_OFF) {
+            // chrono_tick() owns the tubes
+            vTaskDelay(pdMS_TO_TICKS(20));
+            continue;
+        }
+
+        frame_t    value;
+        rotation_t rotation;
+        display_state_t st = {
+            .time_set    = time_set,
+            .blank       = s_display_blank,
+            .alarm_until = s_alarm_until,
+            .rotation    = &rotation,
+        };
+        portENTER_CRITICAL(&tube_mux);
+        rotation = s_rotation;
+        value    = s_value_frame;
+        if (s_value_valid) st.value = &value;
+        portEXIT_CRITICAL(&tube_mux);
+
+        frame_t frame;
+        uint8_t page = display_render(&st, &tv, &tmv, &frame);
+        if (frame_commit(&frame)) s_page_commits[page]++;
 
         vTaskDelay(pdMS_TO_TICKS(20)); // ~50 Hz Refresh
     }
 }
 
+/* ------------------------------------------------------------
+   Stopwatch / countdown
+
+   While active, an esp_timer renders the chrono page every 10 ms
+   from the microsecond time base and commits it directly, so
+   every hundredth reaches tube_list independent of display_task
+   and the FreeRTOS tick. The multiplex ISR latches one whole
+   frame per 8 ms scan (mux_scan.h), so each 10 ms frame is shown;
+   /api/chrono reports the frames it latched and any it dropped.
+
+   s_chrono_lock makes chrono_command() the one owner of mode
+   changes and of starting/stopping the timer; chrono_tick() takes
+   it too before it switches a finished countdown off, so the mode
+   and the timer never disagree.
+   ------------------------------------------------------------ */
+
+static esp_timer_handle_t s_chrono_timer = NULL;
+static SemaphoreHandle_t  s_chrono_lock  = NULL;
+
+static void chrono_tick(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    bool off = false;
+
+    portENTER_CRITICAL(&chrono_mux);
+    if (s_chrono.mode == CHRONO_COUNTDOWN && s_chrono.running && chrono_value_us(now) == 0) {
+        s_chrono.acc_us  = s_chrono.total_us;
+        s_chrono.running = false;
+        s_chrono.done_us = now;
+    }
+    off = s_chrono.done_us && now - s_chrono.done_us > CHRONO_DONE_FLASH;
+    portEXIT_CRITICAL(&chrono_mux);
+
+    if (off) {
+        // A command in progress owns mode and timer; try again next tick
+        if (xSemaphoreTake(s_chrono_lock, 0) != pdTRUE) return;
+        portENTER_CRITICAL(&chrono_mux);
+        off = s_chrono.done_us && now - s_chrono.done_us > CHRONO_DONE_FLASH;
+        if (off) s_chrono.mode = CHRONO_OFF;
+        portEXIT_CRITICAL(&chrono_mux);
+        if (off) esp_timer_stop(s_chrono_timer);
+        xSemaphoreGive(s_chrono_lock);
+        if (off) return;
+    }
+
+    frame_t frame;
+    render_chrono(&frame);
+    if (frame_commit(&frame)) s_page_commits[PAGE_CHRONO]++;
+}
+
+static void chrono_start(void)
+{
+    MEM_MUTEX_CREATE(s_chrono_lock);
+
+    const esp_timer_create_args_t args = {
+        .callback        = chrono_tick,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name            = "chrono",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &s_chrono_timer));
+}
+
+/* chrono_command() with s_chrono_lock held */
+static esp_err_t chrono_apply(const char *cmd, uint32_t secs)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&chrono_mux);
+    chrono_mode_t before = s_chrono.mode;
+    if (strcmp(cmd, "stopwatch") == 0 || strcmp(cmd, "countdown") == 0) {
+        bool cd = (cmd[0] == 'c');
+        if (cd && (secs == 0 || secs > 99 * 3600)) {
+            portEXIT_CRITICAL(&chrono_mux);
+            return ESP_ERR_INVALID_ARG;
+        }
+        s_chrono.mode     = cd ? CHRONO_COUNTDOWN : CHRONO_STOPWATCH;
+        s_chrono.total_us = cd ? (int64_t)secs * 1000000LL : 0;
+        s_chrono.running  = false;
+        s_chrono.acc_us   = 0;
+        s_chrono.done_us  = 0;
+    } else if (strcmp(cmd, "start") == 0) {
+        if (s_chrono.mode == CHRONO_OFF) {
+            s_chrono.mode   = CHRONO_STOPWATCH;
+            s_chrono.acc_us = 0;
+        }
+        if (!s_chrono.running && !s_chrono.done_us) {
+            s_chrono.running = true;
+            s_chrono.base_us = now;
+        }
+    } else if (strcmp(cmd, "stop") == 0) {
+        if (s_chrono.running) {
+            s_chrono.acc_us += now - s_chrono.base_us;
+            s_chrono.running = false;
+        }
+    } else if (strcmp(cmd, "reset") == 0) {
+        s_chrono.running = false;
+        s_chrono.acc_us  = 0;
+        s_chrono.done_us = 0;
+    } else if (strcmp(cmd, "off") == 0) {
+        s_chrono.mode    = CHRONO_OFF;
+        s_chrono.running = false;
+        s_chrono.done_us = 0;
+    } else {
+        portEXIT_CRITICAL(&chrono_mux);
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_chrono.last_cs = -1;
+    s_chrono.skipped = 0;
+    chrono_mode_t after = s_chrono.mode;
+    portEXIT_CRITICAL(&chrono_mux);
+
+    portENTER_CRITICAL(&tube_mux);
+    s_chrono.latched_base = s_mux_scan.latched;
+    s_chrono.dropped_base = s_mux_scan.dropped;
+    portEXIT_CRITICAL(&tube_mux);
+
+    if (before == CHRONO_OFF && after != CHRONO_OFF) {
+        s_page_commits[PAGE_CHRONO] = 0;
+        esp_err_t err = esp_timer_start_periodic(s_chrono_timer, CHRONO_TICK_US);
+        if (err != ESP_OK) {
+            // Without the timer nothing renders; give the tubes back to the clock
+            portENTER_CRITICAL(&chrono_mux);
+            s_chrono.mode    = CHRONO_OFF;
+            s_chrono.running = false;
+            portEXIT_CRITICAL(&chrono_mux);
+            ESP_LOGE(TAG, "Chrono-Timer startet nicht: %s", esp_err_to_name(err));
+            return err;
+        }
+    } else if (before != CHRONO_OFF && after == CHRONO_OFF) {
+        esp_timer_stop(s_chrono_timer);
+    }
+
+    ESP_LOGI(TAG, "Chrono: %s -> %s", cmd, chrono_mode_names[after]);
+    return ESP_OK;
+}
+
+/* Commands: "stopwatch", "countdown" (secs), "start", "stop", "reset", "off".
+   Shared by the web UI, /api/chrono and the console. */
+static esp_err_t chrono_command(const char *cmd, uint32_t secs)
+{
+    xSemaphoreTake(s_chrono_lock, portMAX_DELAY);
+    esp_err_t err = chrono_apply(cmd, secs);
+    xSemaphoreGive(s_chrono_lock);
+    return err;
+}
+
+/* JSON status for /api/chrono and the console */
+static int chrono_status_json(char *out, size_t out_size)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&chrono_mux);
+    chrono_mode_t mode = s_chrono.mode;
+    bool running = s_chrono.running;
+    bool done    = s_chrono.done_us != 0;
+    int64_t us   = chrono_value_us(now);
+    portEXIT_CRITICAL(&chrono_mux);
+
+    // Frames the ISR showed / never showed since the last command
+    portENTER_CRITICAL(&tube_mux);
+    uint32_t latched = s_mux_scan.latched - s_chrono.latched_base;
+    uint32_t dropped = s_mux_scan.dropped - s_chrono.dropped_base;
+    portEXIT_CRITICAL(&tube_mux);
+
+    return snprintf(out, out_size,
+        "{\"mode\":\"%s\",\"running\":%s,\"done\":%s,\"value_ms\":%" PRId64 ","
+        "\"commits\":%" PRIu32 ",\"skipped\":%" PRIu32 ",\"latched\":%" PRIu32 ",\"dropped\":%" PRIu32 "}",
+        chrono_mode_names[mode], running ? "true" : "false", done ? "true" : "false",
+        us / 1000, s_page_commits[PAGE_CHRONO], s_chrono.skipped, latched, dropped);
+}
+
 /* ------------------------------------------------------------
    Config in NVS (WLAN + TZ)
    ------------------------------------------------------------ */
 
 typedef struct {
-    char ssid[32];
+    char ssid[33];      // 802.11 allows 32 bytes, plus terminator
     char password[64];
     char tz[32];
     bool has_wifi;
+    bool lan_sync;      // take sub-second phase from an elected LAN master
+    char rotation[64];  // display pages, see page_rotation_parse()
 } clock_config_t;
 
 static clock_config_t g_cfg;
@@ -327,6 +939,7 @@ static void config_set_defaults(void)
     memset(&g_cfg, 0, sizeof(g_cfg));
     // Standard: Germany / Central Europe with summer time
     strcpy(g_cfg.tz, "CET-1CEST,M3.5.0,M10.5.0/3");
+    strcpy(g_cfg.rotation, "time,date@50+5");
     g_cfg.has_wifi = false;
 }
 
@@ -358,10 +971,21 @@ static void config_load(void)
         // remains default
     }
 
+    uint8_t u8;
+    if (nvs_get_u8(h, "lansync", &u8) == ESP_OK) {
+        g_cfg.lan_sync = (u8 != 0);
+    }
+
+    len = sizeof(g_cfg.rotation);
+    if (nvs_get_str(h, "rotation", g_cfg.rotation, &len) != ESP_OK ||
+        !page_rotation_parse(g_cfg.rotation)) {
+        strcpy(g_cfg.rotation, "time,date@50+5");
+    }
+
     nvs_close(h);
 
-    ESP_LOGI(TAG, "Konfiguration geladen: has_wifi=%d, ssid='%s', tz='%s'",
-             g_cfg.has_wifi, g_cfg.ssid, g_cfg.tz);
+    ESP_LOGI(TAG, "Konfiguration geladen: has_wifi=%d, ssid='%s', tz='%s', lansync=%d, rotation='%s'",
+             g_cfg.has_wifi, g_cfg.ssid, g_cfg.tz, g_cfg.lan_sync, g_cfg.rotation);
 }
 
 static void config_save(void)
@@ -371,23 +995,237 @@ static void config_save(void)
     ESP_ERROR_CHECK(nvs_set_str(h, "ssid", g_cfg.ssid));
     ESP_ERROR_CHECK(nvs_set_str(h, "pass", g_cfg.password));
     ESP_ERROR_CHECK(nvs_set_str(h, "tz",   g_cfg.tz));
+    ESP_ERROR_CHECK(nvs_set_u8(h, "lansync", g_cfg.lan_sync ? 1 : 0));
+    ESP_ERROR_CHECK(nvs_set_str(h, "rotation", g_cfg.rotation));
     ESP_ERROR_CHECK(nvs_commit(h));
     nvs_close(h);
 
     ESP_LOGI(TAG, "Konfiguration gespeichert.");
 }
 
+/* ------------------------------------------------------------
+   Scheduler (night blanking, LED brightness, alarms)
+
+   Entry format and occurrence arithmetic live in sched.c. Each
+   entry caches its next occurrence as an epoch time; sched_task
+   sleeps until the earliest one and is only woken early when the
+   schedule changes or the clock is stepped. After such a wake-up
+   the latest past blank/wake and brightness entries are replayed,
+   so a reboot at night comes back dark, and alarms that fell due
+   before the wake-up still fire once (sched_rebase()).
+   ------------------------------------------------------------ */
+
+#define SCHED_MAX_SLEEP_S 3600   // re-check at least hourly
+
+static sched_entry_t     s_sched[SCHED_MAX_ENTRIES];
+static time_t            s_sched_due[SCHED_MAX_ENTRIES];  // next occurrence, -1 = never
+static size_t            s_sched_count = 0;
+static volatile time_t   s_sched_next  = -1;
+static volatile int      s_sched_next_idx = -1;
+static volatile uint32_t s_sched_fired = 0;
+static SemaphoreHandle_t s_sched_lock  = NULL;
+static TaskHandle_t      s_sched_task  = NULL;
+
+static void sched_apply(const sched_entry_t *e, time_t when)
+{
+    switch (e->action) {
+    case SCHED_ACT_BLANK:
+        s_display_blank = true;
+        break;
+    case SCHED_ACT_WAKE:
+        s_display_blank = false;
+        break;
+    case SCHED_ACT_BRIGHTNESS:
+        portENTER_CRITICAL(&tube_mux);
+        led_pwm_off = MIN(e->arg, 8);
+        portEXIT_CRITICAL(&tube_mux);
+        break;
+    case SCHED_ACT_ALARM:
+        s_alarm_until = when + 60 * (e->arg ? e->arg : 1);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Cache the earliest due entry; call with s_sched_lock held */
+static void sched_update_next(void)
+{
+    time_t next = -1;
+    int idx = -1;
+    for (size_t i = 0; i < s_sched_count; i++) {
+        if (s_sched_due[i] == (time_t)-1) continue;
+        if (next == (time_t)-1 || s_sched_due[i] < next) {
+            next = s_sched_due[i];
+            idx  = (int)i;
+        }
+    }
+    s_sched_next     = next;
+    s_sched_next_idx = idx;
+}
+
+/* Recompute all occurrences and replay the current state; lock held */
+static void sched_resync(time_t now)
+{
+    size_t late[SCHED_MAX_ENTRIES];
+    time_t late_at[SCHED_MAX_ENTRIES];
+    size_t n_late = sched_rebase(s_sched, s_sched_count, now, s_sched_due, late, late_at);
+
+    sched_state_t st;
+    sched_state_at(s_sched, s_sched_count, now, &st);
+
+    if (st.blank >= 0) sched_apply(&s_sched[st.blank], st.blank_at);
+    else               s_display_blank = false;
+
+    if (st.brightness >= 0) {
+        sched_apply(&s_sched[st.brightness], st.brightness_at);
+    } else {
+        portENTER_CRITICAL(&tube_mux);
+        led_pwm_off = LED_PWM_DEFAULT;
+        portEXIT_CRITICAL(&tube_mux);
+    }
+
+    // Alarms that fell due before the step or notify still fire, once
+    for (size_t k = 0; k < n_late; k++) {
+        ESP_LOGI(TAG, "Zeitplan: %s (nachgeholt)", sched_action_names[s_sched[late[k]].action]);
+        sched_apply(&s_sched[late[k]], late_at[k]);
+        s_sched_fired++;
+    }
+
+    sched_update_next();
+}
+
+/* Fire everything due at 'now'; lock held */
+static void sched_fire_due(time_t now)
+{
+    for (size_t i = 0; i < s_sched_count; i++) {
+        if (s_sched_due[i] == (time_t)-1 || s_sched_due[i] > now) continue;
+        ESP_LOGI(TAG, "Zeitplan: %s", sched_action_names[s_sched[i].action]);
+        sched_apply(&s_sched[i], s_sched_due[i]);
+        s_sched_fired++;
+        s_sched_due[i] = sched_next_after(&s_sched[i], now);
+    }
+    sched_update_next();
+}
+
+/* Wake sched_task to re-read schedule and clock (schedule edited, time stepped) */
+static void sched_notify(void)
+{
+    if (s_sched_task) xTaskNotifyGive(s_sched_task);
+}
+
+static void sched_task(void *arg)
+{
+    s_sched_task = xTaskGetCurrentTaskHandle();
+    bool resync = true;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;   // until notified when the time is unknown
+
+        if (time_set) {
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+
+            xSemaphoreTake(s_sched_lock, portMAX_DELAY);
+            if (resync) sched_resync(tv.tv_sec);
+            else        sched_fire_due(tv.tv_sec);
+            time_t next = s_sched_next;
+            xSemaphoreGive(s_sched_lock);
+
+            int64_t sleep_ms = (int64_t)SCHED_MAX_SLEEP_S * 1000;
+            if (next != (time_t)-1) {
+                int64_t until = ((int64_t)next - tv.tv_sec) * 1000 - tv.tv_usec / 1000 + 5;
+                if (until < sleep_ms) sleep_ms = until;
+            }
+            if (sleep_ms < 10) sleep_ms = 10;
+            wait = pdMS_TO_TICKS(sleep_ms);
+        }
+
+        resync = ulTaskNotifyTake(pdTRUE, wait) > 0;
+    }
+}
+
+static void sched_load(void)
+{
+    nvs_handle_t h;
+    if (nvs_open("clock", NVS_READONLY, &h) != ESP_OK) return;
+
+    sched_entry_t blob[SCHED_MAX_ENTRIES];
+    size_t len = sizeof(blob);
+    esp_err_t err = nvs_get_blob(h, "sched", blob, &len);
+    nvs_close(h);
+    if (err != ESP_OK) return;
+
+    // A corrupt or foreign blob must not index past sched_action_names
+    // or schedule 25:61; keep only entries the parser would accept.
+    size_t n = len / sizeof(sched_entry_t), dropped = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (sched_entry_valid(&blob[i])) s_sched[s_sched_count++] = blob[i];
+        else                             dropped++;
+    }
+    if (dropped) ESP_LOGW(TAG, "Zeitplan: %u ungültige Einträge verworfen", (unsigned)dropped);
+
+    ESP_LOGI(TAG, "Zeitplan geladen: %u Einträge", (unsigned)s_sched_count);
+}
+
+static esp_err_t sched_save(void)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open("clock", NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+
+    if (s_sched_count) err = nvs_set_blob(h, "sched", s_sched, s_sched_count * sizeof(sched_entry_t));
+    else               err = nvs_erase_key(h, "sched");
+    if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+/* Replace the whole schedule (from the web UI) */
+static esp_err_t sched_replace(const sched_entry_t *entries, size_t count)
+{
+    xSemaphoreTake(s_sched_lock, portMAX_DELAY);
+    // Entries already due fire from the old table; the new one starts
+    // without due times (indices changed), so its resync fires nothing late
+    if (time_set) {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        sched_fire_due(tv.tv_sec);
+    }
+    memcpy(s_sched, entries, count * sizeof(sched_entry_t));
+    s_sched_count = count;
+    for (size_t i = 0; i < SCHED_MAX_ENTRIES; i++) s_sched_due[i] = (time_t)-1;
+    esp_err_t err = sched_save();
+    xSemaphoreGive(s_sched_lock);
+
+    sched_notify();
+    return err;
+}
+
+static void sched_start(void)
+{
+    for (size_t i = 0; i < SCHED_MAX_ENTRIES; i++) s_sched_due[i] = (time_t)-1;
+    MEM_MUTEX_CREATE(s_sched_lock);
+    sched_load();
+    MEM_TASK_CREATE(sched_task, "sched_task", CONFIG_IV3_SCHED_TASK_STACK, 5);
+}
+
 /* ------------------------------------------------------------
    WiFi + SNTP + Web server
    ------------------------------------------------------------ */
 
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
+#define WIFI_SCAN_DONE_BIT BIT2
 #define WIFI_MAX_RETRY     5
 
 static EventGroupHandle_t s_wifi_event_group;
 static int s_retry_num = 0;
 static bool s_ap_mode = false;
+static volatile uint8_t s_ap_clients = 0;   // stations on the setup AP
+static bool s_sta_autoconnect = false;   // connect on STA_START (not in setup AP)
+static volatile bool s_discovery_stale = true;   // IP/mode changed, rebuild discovery reply
 
 static esp_netif_t *s_sta_netif = NULL;
 static esp_netif_t *s_ap_netif  = NULL;
@@ -395,10 +1233,51 @@ static esp_netif_t *s_ap_netif  = NULL;
 /* Forward Decl for SNTP */
 static void initialize_sntp(void);
 
+/* SNTP runs unless LAN sync follows a master that has it off (lansync_clk_source) */
+static volatile bool s_sntp_wanted = true;
+
+/* When and by how much the clock was last corrected (reported by discovery) */
+typedef enum {
+    SYNC_NONE = 0,
+    SYNC_SNTP,
+    SYNC_LAN,
+} sync_source_t;
+
+typedef struct {
+    volatile int64_t last_us;      // esp_timer time of last sync, 0 = never
+    volatile int32_t offset_us;    // correction at last sync
+    volatile int32_t drift_ppb;    // free-running drift between the last two SNTP syncs, 0 = unknown
+    volatile uint8_t source;       // sync_source_t
+    volatile bool    sntp_synced;  // SNTP answered at least once (own time source)
+    int64_t ref_mono_us;           // esp_timer and wall time at last SNTP sync,
+    int64_t ref_wall_us;           // ref_mono_us = 0 when slewed since
+} sync_stats_t;
+
+static sync_stats_t s_sync = { 0 };
+
 /* SNTP callback: Time is synchronized */
 static void time_sync_notification_cb(struct timeval *tv)
 {
+    // Wall time runs off the same counter as esp_timer, so the step
+    // against the last reference is the oscillator drift since then
+    int64_t mono = esp_timer_get_time();
+    int64_t wall = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+    if (s_sync.ref_mono_us) {
+        int64_t elapsed = mono - s_sync.ref_mono_us;
+        int64_t offset  = wall - (s_sync.ref_wall_us + elapsed);
+        s_sync.offset_us = lansync_clamp32(offset);
+        if (elapsed >= 60000000LL) {
+            s_sync.drift_ppb = lansync_clamp32(offset * 1000 / (elapsed / 1000000));
+        }
+    }
+    s_sync.ref_mono_us = mono;
+    s_sync.ref_wall_us = wall;
+    s_sync.last_us     = mono;
+    s_sync.source      = SYNC_SNTP;
+    s_sync.sntp_synced = true;
+
     time_set = true;
+    sched_notify();
     ESP_LOGI(TAG, "Zeit per SNTP synchronisiert.");
 }
 
@@ -419,9 +1298,13 @@ static void wifi_event_handler(void* arg,
                                void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
+        if (s_sta_autoconnect) esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE) {
+        xEventGroupSetBits(s_wifi_event_group, WIFI_SCAN_DONE_BIT);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < WIFI_MAX_RETRY) {
+        if (!s_sta_autoconnect) {
+            // STA only used for scanning in setup mode
+        } else if (s_retry_num < WIFI_MAX_RETRY) {
             esp_wifi_connect();
             s_retry_num++;
             ESP_LOGI(TAG, "WiFi-STA: Retry %d", s_retry_num);
@@ -434,12 +1317,21 @@ static void wifi_event_handler(void* arg,
         s_retry_num = 0;
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
         s_ap_mode = false;
+        s_discovery_stale = true;
 
-        // Once IP address is available: Start NTP
-        initialize_sntp();
+        // Once IP address is available: Start NTP. Not again after a
+        // reconnect (it keeps running), and not while LAN sync follows
+        // a master and has switched it off.
+        if (s_sntp_wanted && !esp_sntp_enabled()) initialize_sntp();
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_START) {
         ESP_LOGI(TAG, "SoftAP gestartet.");
         s_ap_mode = true;
+        s_ap_clients = 0;
+        s_discovery_stale = true;
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) {
+        s_ap_clients++;
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STADISCONNECTED) {
+        if (s_ap_clients) s_ap_clients--;
     }
 }
 
@@ -472,14 +1364,14 @@ static void wifi_start_sta(void)
     ESP_LOGI(TAG, "Starte WiFi im STA-Modus, SSID='%s'", g_cfg.ssid);
 
     wifi_config_t wifi_config = { 0 };
-    strncpy((char*)wifi_config.sta.ssid,
-            g_cfg.ssid,
-            sizeof(wifi_config.sta.ssid) - 1);
+    // A 32-byte SSID fills the field without terminator; the driver accepts that
+    memcpy(wifi_config.sta.ssid, g_cfg.ssid, strnlen(g_cfg.ssid, sizeof(wifi_config.sta.ssid)));
     strncpy((char*)wifi_config.sta.password,
             g_cfg.password,
             sizeof(wifi_config.sta.password) - 1);
 
     wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    s_sta_autoconnect = true;
 
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
@@ -506,7 +1398,9 @@ static void wifi_start_ap(void)
         ap_config.ap.authmode = WIFI_AUTH_OPEN;
     }
 
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
+    // AP+STA: the idle STA interface lets the scanner list networks for /config
+    s_sta_autoconnect = false;
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
     ESP_ERROR_CHECK(esp_wifi_start());
 
@@ -519,44 +1413,656 @@ static void wifi_start_ap(void)
 }
 
 /* ------------------------------------------------------------
-   HTTP-Server
+   Wi-Fi scan cache
+
+   wifi_scan_task scans in the background on a rate-limited
+   schedule (often in setup mode, rarely once connected) and keeps
+   the strongest networks, one per SSID, in a small cache. The
+   /config page renders its SSID list from the cache and never
+   waits for a scan; a stale cache only nudges the task. While a
+   phone or laptop is associated with the setup AP, scans only run
+   on such a request: each one takes the radio off the AP channel
+   for a few seconds.
    ------------------------------------------------------------ */
 
-static httpd_handle_t s_http_server = NULL;
+#define SCAN_CACHE_MAX       12
+#define SCAN_RECORDS_MAX     24
+#define SCAN_PERIOD_AP_S     60      // setup mode, nobody associated yet
+#define SCAN_PERIOD_STA_S    900     // connected: scans cost airtime
+#define SCAN_MIN_INTERVAL_S  20      // on-demand requests are rate-limited to this
+#define SCAN_STALE_S         60      // /config asks for a refresh beyond this age
+#define SCAN_TIMEOUT_MS      8000
 
-/* URL decoding (very easy) */
-static void url_decode(char *dst, const char *src)
-{
-    char a, b;
-    while (*src) {
-        if (*src == '%' &&
-            (a = src[1]) && (b = src[2]) &&
-            isxdigit((unsigned char)a) && isxdigit((unsigned char)b)) {
-
-            a = tolower((unsigned char)a);
-            b = tolower((unsigned char)b);
-            a = (a >= 'a') ? (a - 'a' + 10) : (a - '0');
-            b = (b >= 'a') ? (b - 'a' + 10) : (b - '0');
-            *dst++ = (char)(16 * a + b);
-            src += 3;
-        } else if (*src == '+') {
-            *dst++ = ' ';
-            src++;
-        } else {
-            *dst++ = *src++;
-        }
+typedef struct {
+    char    ssid[33];
+    int8_t  rssi;
+    uint8_t channel;
+    uint8_t authmode;    // wifi_auth_mode_t
+} scan_net_t;
+
+typedef struct {
+    scan_net_t nets[SCAN_CACHE_MAX];
+    size_t     count;
+    int64_t    done_us;        // esp_timer time of last completed scan, 0 = none
+    uint32_t   duration_ms;    // last scan duration
+    uint32_t   scans;
+    uint32_t   failures;
+} scan_cache_t;
+
+static scan_cache_t      s_scan = { 0 };
+static SemaphoreHandle_t s_scan_lock = NULL;
+static TaskHandle_t      s_scan_task = NULL;
+static wifi_ap_record_t  s_scan_records[SCAN_RECORDS_MAX];   // only touched by wifi_scan_task
+
+static const char *wifi_auth_str(uint8_t mode)
+{
+    switch (mode) {
+    case WIFI_AUTH_OPEN:            return "open";
+    case WIFI_AUTH_WEP:             return "WEP";
+    case WIFI_AUTH_WPA_PSK:         return "WPA";
+    case WIFI_AUTH_WPA2_PSK:        return "WPA2";
+    case WIFI_AUTH_WPA_WPA2_PSK:    return "WPA/WPA2";
+    case WIFI_AUTH_WPA2_ENTERPRISE: return "WPA2-Ent";
+    case WIFI_AUTH_WPA3_PSK:        return "WPA3";
+    case WIFI_AUTH_WPA2_WPA3_PSK:   return "WPA2/WPA3";
+    default:                        return "other";
     }
-    *dst = '\0';
 }
 
-/* Root page: Status + AP IP address + some nice CSS */
-static esp_err_t root_get_handler(httpd_req_t *req)
+/* Age of the cache in seconds, -1 if never scanned; s_scan_lock held */
+static int32_t wifi_scan_age_locked(void)
+{
+    int64_t done = s_scan.done_us;
+    return done ? (int32_t)((esp_timer_get_time() - done) / 1000000) : -1;
+}
+
+static int32_t wifi_scan_age_s(void)
+{
+    xSemaphoreTake(s_scan_lock, portMAX_DELAY);
+    int32_t age = wifi_scan_age_locked();
+    xSemaphoreGive(s_scan_lock);
+    return age;
+}
+
+/* Ask for a refresh; the task enforces SCAN_MIN_INTERVAL_S */
+static void wifi_scan_request(void)
+{
+    if (s_scan_task) xTaskNotifyGive(s_scan_task);
+}
+
+static void wifi_scan_once(void)
+{
+    wifi_scan_config_t cfg = {
+        .show_hidden = false,
+        .scan_type   = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active = { .min = 60, .max = 120 },   // ms per channel
+    };
+
+    int64_t start = esp_timer_get_time();
+    xEventGroupClearBits(s_wifi_event_group, WIFI_SCAN_DONE_BIT);
+    esp_err_t err = esp_wifi_scan_start(&cfg, false);
+    if (err == ESP_OK) {
+        EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, WIFI_SCAN_DONE_BIT,
+                                               pdTRUE, pdFALSE, pdMS_TO_TICKS(SCAN_TIMEOUT_MS));
+        if (!(bits & WIFI_SCAN_DONE_BIT)) err = ESP_ERR_TIMEOUT;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "WiFi-Scan fehlgeschlagen: %s", esp_err_to_name(err));
+        s_scan.failures++;
+        esp_wifi_clear_ap_list();
+        return;
+    }
+
+    uint16_t n = SCAN_RECORDS_MAX;
+    if (esp_wifi_scan_get_ap_records(&n, s_scan_records) != ESP_OK) n = 0;  // also frees the driver list
+
+    // One entry per SSID (strongest BSS), strongest first
+    scan_net_t nets[SCAN_CACHE_MAX];
+    size_t count = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        const wifi_ap_record_t *r = &s_scan_records[i];
+        if (r->ssid[0] == '\0') continue;
+
+        size_t j;
+        for (j = 0; j < count; j++) {
+            if (strcmp(nets[j].ssid, (const char *)r->ssid) == 0) break;
+        }
+        if (j < count) {
+            if (r->rssi <= nets[j].rssi) continue;
+        } else if (count < SCAN_CACHE_MAX) {
+            j = count++;
+        } else {
+            // Full: replace the weakest if this one is stronger
+            size_t weakest = 0;
+            for (size_t k = 1; k < count; k++) {
+                if (nets[k].rssi < nets[weakest].rssi) weakest = k;
+            }
+            if (r->rssi <= nets[weakest].rssi) continue;
+            j = weakest;
+        }
+        memcpy(nets[j].ssid, r->ssid, sizeof(nets[j].ssid));
+        nets[j].ssid[sizeof(nets[j].ssid) - 1] = '\0';
+        nets[j].rssi     = r->rssi;
+        nets[j].channel  = r->primary;
+        nets[j].authmode = (uint8_t)r->authmode;
+    }
+
+    for (size_t i = 1; i < count; i++) {   // insertion sort, at most 12 entries
+        scan_net_t t = nets[i];
+        size_t k = i;
+        while (k > 0 && nets[k - 1].rssi < t.rssi) { nets[k] = nets[k - 1]; k--; }
+        nets[k] = t;
+    }
+
+    int64_t end = esp_timer_get_time();
+    xSemaphoreTake(s_scan_lock, portMAX_DELAY);
+    memcpy(s_scan.nets, nets, count * sizeof(scan_net_t));
+    s_scan.count       = count;
+    s_scan.done_us     = end;
+    s_scan.duration_ms = (uint32_t)((end - start) / 1000);
+    s_scan.scans++;
+    xSemaphoreGive(s_scan_lock);
+
+    ESP_LOGI(TAG, "WiFi-Scan: %u Netze in %" PRIu32 " ms", (unsigned)count, s_scan.duration_ms);
+}
+
+static void wifi_scan_task(void *arg)
+{
+    s_scan_task = xTaskGetCurrentTaskHandle();
+    bool requested = false;
+
+    while (1) {
+        bool on_demand_only = s_ap_mode && s_ap_clients > 0;
+        int32_t age = wifi_scan_age_s();
+        if ((requested || !on_demand_only) && (age < 0 || age >= SCAN_MIN_INTERVAL_S)) {
+            wifi_scan_once();
+        }
+
+        // With AP clients the timeout only re-checks whether they left
+        uint32_t period = (s_ap_mode && !on_demand_only) ? SCAN_PERIOD_AP_S : SCAN_PERIOD_STA_S;
+        requested = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(period * 1000)) > 0;
+        if (requested) {
+            // On-demand: wait out the minimum interval instead of dropping the request
+            age = wifi_scan_age_s();
+            if (age >= 0 && age < SCAN_MIN_INTERVAL_S) {
+                vTaskDelay(pdMS_TO_TICKS((SCAN_MIN_INTERVAL_S - age) * 1000));
+            }
+        }
+    }
+}
+
+static void wifi_scan_start(void)
+{
+    MEM_MUTEX_CREATE(s_scan_lock);
+    MEM_TASK_CREATE(wifi_scan_task, "wifi_scan_task", CONFIG_IV3_SCAN_TASK_STACK, 4);
+}
+
+/* ------------------------------------------------------------
+   LAN time sync (protocol and election in lansync.c)
+
+   lansync_task owns the UDP socket and supplies the clock:
+   wall time via gettimeofday/settimeofday/adjtime, SNTP as the
+   own time source. Modem power save is off while LAN sync runs;
+   otherwise broadcasts are only delivered at DTIM beacons and
+   arrive 100 ms or more late, which would feed straight into
+   the measured offset.
+   ------------------------------------------------------------ */
+
+static lansync_state_t s_lansync = { .role = LANSYNC_OFF };
+
+static int64_t lansync_clk_mono(void *ctx) { return esp_timer_get_time(); }
+
+static int64_t lansync_clk_wall(void *ctx)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void lansync_clk_step(void *ctx, int64_t delta_us)
+{
+    int64_t t = lansync_clk_wall(ctx) + delta_us;
+    struct timeval set = { .tv_sec = (time_t)(t / 1000000LL), .tv_usec = (suseconds_t)(t % 1000000LL) };
+    settimeofday(&set, NULL);
+    time_set = true;
+    sched_notify();
+}
+
+static bool lansync_clk_slew(void *ctx, int32_t delta_us)
+{
+    struct timeval delta = { .tv_sec = 0, .tv_usec = (suseconds_t)delta_us };
+    return adjtime(&delta, NULL) == 0;
+}
+
+static void lansync_clk_source(void *ctx, bool on)
+{
+    s_sntp_wanted = on;
+    if (on && !esp_sntp_enabled())  initialize_sntp();
+    if (!on && esp_sntp_enabled())  esp_sntp_stop();
+}
+
+static const lansync_clock_t s_lansync_clock = {
+    .mono_us    = lansync_clk_mono,
+    .wall_us    = lansync_clk_wall,
+    .step       = lansync_clk_step,
+    .slew       = lansync_clk_slew,
+    .own_source = lansync_clk_source,
+};
+
+static void lansync_log(unsigned ev)
+{
+    if (ev & LANSYNC_EV_YIELDED)
+        ESP_LOGI(TAG, "LAN-Sync: Master %08" PRIx32 " hat Vorrang, wechsle zu Follower", s_lansync.master_id);
+    if (ev & LANSYNC_EV_NEW_MASTER)
+        ESP_LOGI(TAG, "LAN-Sync: folge Master %08" PRIx32, s_lansync.master_id);
+    if (ev & LANSYNC_EV_MASTER_LOST)
+        ESP_LOGW(TAG, "LAN-Sync: Master verloren, zurück zu SNTP");
+    if (ev & LANSYNC_EV_CLAIMED)
+        ESP_LOGI(TAG, "LAN-Sync: übernehme Master-Rolle");
+}
+
+static void lansync_task(void *arg)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "LAN-Sync: socket() fehlgeschlagen");
+        mem_task_exit();
+        return;
+    }
+
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in addr = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(LANSYNC_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "LAN-Sync: bind() fehlgeschlagen");
+        close(sock);
+        mem_task_exit();
+        return;
+    }
+
+    struct sockaddr_in dst = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(LANSYNC_PORT),
+        .sin_addr.s_addr = htonl(INADDR_BROADCAST),
+    };
+
+    const lansync_clock_t *clk = &s_lansync_clock;
+    lansync_init(&s_lansync, s_lansync.node_id, clk);
+    ESP_LOGI(TAG, "LAN-Sync aktiv, Node-ID %08" PRIx32 ", Port %d", s_lansync.node_id, LANSYNC_PORT);
+
+    int64_t next_sec = lansync_clk_wall(NULL) / 1000000 + 1;
+
+    while (1) {
+        // Sleep until the next second boundary (master beacon slot) or a packet
+        int64_t wait = next_sec * 1000000LL - lansync_clk_wall(NULL);
+        if (wait < 0) wait = 0;
+        if (wait > 1000000) wait = 1000000;   // clock was stepped back
+        struct timeval timeout = { .tv_sec = 0, .tv_usec = (suseconds_t)wait };
+
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(sock, &rfds);
+        if (select(sock + 1, &rfds, NULL, NULL, &timeout) > 0) {
+            lansync_pkt_t pkt;
+            int n = recv(sock, &pkt, sizeof(pkt), 0);
+            int64_t rx = lansync_clk_wall(NULL);
+            lansync_local_t local = { .time_valid = time_set, .has_source = s_sync.sntp_synced };
+            unsigned ev = lansync_on_packet(&s_lansync, clk, &local, &pkt, n, rx);
+            if (ev & LANSYNC_EV_BEACON) {
+                s_sync.last_us     = s_lansync.last_beacon_us;
+                s_sync.offset_us   = s_lansync.offset_us;
+                s_sync.source      = SYNC_LAN;
+                s_sync.ref_mono_us = 0;   // slewed: no SNTP drift reference any more
+                s_sync.drift_ppb   = 0;   // measured against that reference, unknown now
+            }
+            lansync_log(ev);
+        }
+
+        int64_t now = lansync_clk_wall(NULL);
+        if (now < next_sec * 1000000LL) {
+            if (next_sec * 1000000LL - now > 1000000) next_sec = now / 1000000 + 1;
+            continue;
+        }
+        next_sec = now / 1000000 + 1;
+
+        // Second boundary reached
+        lansync_local_t local = { .time_valid = time_set, .has_source = s_sync.sntp_synced };
+        unsigned ev = lansync_on_second(&s_lansync, clk, &local);
+        lansync_log(ev);
+
+        if (ev & LANSYNC_EV_SEND_BEACON) {
+            lansync_pkt_t pkt;
+            lansync_beacon(&s_lansync, clk, &local, &pkt);
+            sendto(sock, &pkt, sizeof(pkt), 0, (struct sockaddr *)&dst, sizeof(dst));
+        }
+    }
+}
+
+static void lansync_start(void)
+{
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    s_lansync.node_id = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) |
+                        ((uint32_t)mac[4] << 8)  |  (uint32_t)mac[5];
+
+    // Broadcast beacons must not wait for the next DTIM
+    esp_wifi_set_ps(WIFI_PS_NONE);
+
+    MEM_TASK_CREATE(lansync_task, "lansync_task", CONFIG_IV3_LANSYNC_TASK_STACK, 8);
+}
+
+/* ------------------------------------------------------------
+   Discovery responder
+
+   Host tools broadcast one query to UDP port 12322 and every clock
+   on the subnet answers with a fixed-size binary reply: identity
+   (MAC), firmware version, IP, mode, sync source/age, last
+   correction and drift. The reply is kept ready in a static
+   buffer; per query only the time-dependent fields are patched
+   before sendto(), so answering costs a few stores. IP and mode
+   are refreshed only after the WiFi handler marks them stale.
+   See Tools/iv3_discover.py.
+   ------------------------------------------------------------ */
+
+#define DISCOVERY_PORT         12322
+#define DISCOVERY_MAGIC_QUERY  0x49563351u   // "IV3Q"
+#define DISCOVERY_MAGIC_REPLY  0x49563352u   // "IV3R"
+#define DISCOVERY_VERSION      1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  reserved[3];
+} discovery_query_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  mode;            // 0 = station, 1 = setup AP
+    uint8_t  sync_source;     // sync_source_t
+    uint8_t  lansync_role;    // lansync_role_t
+    uint8_t  mac[6];
+    uint8_t  time_set;
+    uint8_t  reserved;
+    uint32_t ip;
+    uint32_t uptime_s;
+    uint32_t sync_age_s;      // UINT32_MAX = never synced
+    int32_t  offset_us;       // correction at last sync
+    int32_t  drift_ppb;       // oscillator drift between the last two SNTP syncs
+    char     fw_version[32];  // NUL-padded
+} discovery_reply_t;          // 68 bytes, all fields in network byte order
+
+static discovery_reply_t s_disc_reply;
+static volatile uint32_t s_disc_queries = 0;   // answered, for /api/status
+
+/* Fields that change with the network (rare) */
+static void discovery_refresh_netinfo(void)
+{
+    s_discovery_stale = false;
+
+    esp_netif_ip_info_t ip_info = { 0 };
+    esp_netif_t *netif = s_ap_mode ? s_ap_netif : s_sta_netif;
+    if (netif) esp_netif_get_ip_info(netif, &ip_info);
+
+    s_disc_reply.mode = s_ap_mode ? 1 : 0;
+    s_disc_reply.ip   = ip_info.ip.addr;   // lwIP keeps it in network order
+}
+
+static void discovery_task(void *arg)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Discovery: socket() fehlgeschlagen");
+        mem_task_exit();
+        return;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(DISCOVERY_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "Discovery: bind() fehlgeschlagen");
+        close(sock);
+        mem_task_exit();
+        return;
+    }
+
+    // Constant part, filled once
+    s_disc_reply.magic   = htonl(DISCOVERY_MAGIC_REPLY);
+    s_disc_reply.version = DISCOVERY_VERSION;
+    esp_read_mac(s_disc_reply.mac, ESP_MAC_WIFI_STA);
+    strncpy(s_disc_reply.fw_version, esp_app_get_description()->version,
+            sizeof(s_disc_reply.fw_version) - 1);
+
+    ESP_LOGI(TAG, "Discovery aktiv, Port %d", DISCOVERY_PORT);
+
+    while (1) {
+        discovery_query_t q;
+        struct sockaddr_in src;
+        socklen_t src_len = sizeof(src);
+        int n = recvfrom(sock, &q, sizeof(q), 0, (struct sockaddr *)&src, &src_len);
+        if (n != sizeof(q) || ntohl(q.magic) != DISCOVERY_MAGIC_QUERY || q.version != DISCOVERY_VERSION) {
+            continue;
+        }
+
+        if (s_discovery_stale) discovery_refresh_netinfo();
+
+        int64_t now     = esp_timer_get_time();
+        int64_t last    = s_sync.last_us;
+        uint32_t age    = last ? (uint32_t)((now - last) / 1000000) : UINT32_MAX;
+        s_disc_reply.sync_source  = s_sync.source;
+        s_disc_reply.lansync_role = (uint8_t)s_lansync.role;
+        s_disc_reply.time_set     = time_set ? 1 : 0;
+        s_disc_reply.uptime_s     = htonl((uint32_t)(now / 1000000));
+        s_disc_reply.sync_age_s   = htonl(age);
+        s_disc_reply.offset_us    = (int32_t)htonl((uint32_t)s_sync.offset_us);
+        s_disc_reply.drift_ppb    = (int32_t)htonl((uint32_t)s_sync.drift_ppb);
+
+        // Unicast back to the asker
+        sendto(sock, &s_disc_reply, sizeof(s_disc_reply), 0, (struct sockaddr *)&src, src_len);
+        s_disc_queries++;
+    }
+}
+
+static void discovery_start(void)
+{
+    MEM_TASK_CREATE(discovery_task, "discovery_task", CONFIG_IV3_DISCOVERY_TASK_STACK, 4);
+}
+
+/* ------------------------------------------------------------
+   HTTP-Server
+   ------------------------------------------------------------ */
+
+static httpd_handle_t s_http_server = NULL;
+
+/* ------------------------------------------------------------
+   HTTP worker pool
+
+   Page renders and handlers that write flash run on a small
+   worker pool (httpd_req_async_handler_begin), so the httpd task
+   keeps accepting and serving other sockets meanwhile. If all
+   workers are busy the request is handled inline as before, on
+   the httpd task's stack, which is why that one is at least as
+   large as a worker's.
+   ------------------------------------------------------------ */
+
+_Static_assert(CONFIG_IV3_HTTPD_TASK_STACK >= CONFIG_IV3_HTTPD_WORKER_STACK,
+               "IV3_HTTPD_TASK_STACK must be >= IV3_HTTPD_WORKER_STACK (inline fallback)");
+
+typedef esp_err_t (*http_handler_fn)(httpd_req_t *req);
+
+typedef struct {
+    httpd_req_t     *req;       // async copy, owned by the worker
+    http_handler_fn  handler;
+} http_job_t;
+
+static QueueHandle_t     s_http_jobs = NULL;
+static SemaphoreHandle_t s_http_idle = NULL;     // counts idle workers
+static volatile uint32_t s_http_async   = 0;
+static volatile uint32_t s_http_inline  = 0;
+
+static void http_worker_task(void *arg)
+{
+    http_job_t job;
+    while (1) {
+        if (xQueueReceive(s_http_jobs, &job, portMAX_DELAY) != pdTRUE) continue;
+        job.handler(job.req);
+        httpd_req_async_handler_complete(job.req);
+        xSemaphoreGive(s_http_idle);
+    }
+}
+
+/* Registered as .handler, the real handler is passed in .user_ctx */
+static esp_err_t http_async_entry(httpd_req_t *req)
+{
+    http_handler_fn handler = (http_handler_fn)req->user_ctx;
+
+    if (s_http_jobs && xSemaphoreTake(s_http_idle, 0) == pdTRUE) {
+        http_job_t job = { .handler = handler };
+        if (httpd_req_async_handler_begin(req, &job.req) == ESP_OK) {
+            if (xQueueSend(s_http_jobs, &job, 0) == pdTRUE) {
+                s_http_async++;
+                return ESP_OK;
+            }
+            httpd_req_async_handler_complete(job.req);
+        }
+        xSemaphoreGive(s_http_idle);
+    }
+
+    s_http_inline++;
+    return handler(req);
+}
+
+static void http_workers_start(void)
+{
+    static const char *const names[] = { "http_worker0", "http_worker1", "http_worker2", "http_worker3" };
+
+#ifdef CONFIG_IV3_STATIC_ALLOC
+    static StackType_t   stacks[CONFIG_IV3_HTTPD_WORKERS][CONFIG_IV3_HTTPD_WORKER_STACK];
+    static StaticTask_t  tcbs[CONFIG_IV3_HTTPD_WORKERS];
+    static StaticQueue_t queue_buf;
+    static uint8_t       queue_storage[CONFIG_IV3_HTTPD_WORKERS * sizeof(http_job_t)];
+    static StaticSemaphore_t idle_buf;
+    s_http_jobs = xQueueCreateStatic(CONFIG_IV3_HTTPD_WORKERS, sizeof(http_job_t), queue_storage, &queue_buf);
+    s_http_idle = xSemaphoreCreateCountingStatic(CONFIG_IV3_HTTPD_WORKERS, CONFIG_IV3_HTTPD_WORKERS, &idle_buf);
+#else
+    s_http_jobs = xQueueCreate(CONFIG_IV3_HTTPD_WORKERS, sizeof(http_job_t));
+    s_http_idle = xSemaphoreCreateCounting(CONFIG_IV3_HTTPD_WORKERS, CONFIG_IV3_HTTPD_WORKERS);
+#endif
+
+    for (int i = 0; i < CONFIG_IV3_HTTPD_WORKERS; i++) {
+#ifdef CONFIG_IV3_STATIC_ALLOC
+        mem_task_create(http_worker_task, names[i], CONFIG_IV3_HTTPD_WORKER_STACK, NULL, 5, stacks[i], &tcbs[i]);
+#else
+        mem_task_create(http_worker_task, names[i], CONFIG_IV3_HTTPD_WORKER_STACK, NULL, 5, NULL, NULL);
+#endif
+    }
+}
+
+/* ------------------------------------------------------------
+   Form handling (decoder in form.c)
+   ------------------------------------------------------------ */
+
+/* Synchronous handlers run on the httpd task, so a client that
+   announces a body and never sends it (or trickles it) must not hold
+   the server: give up after a few receive timeouts (recv_wait_timeout
+   each) or when the whole body took too long. */
+#define FORM_RECV_RETRIES  2
+#define FORM_RECV_MAX_US   10000000LL
+
+/* Receive the complete request body into buf (size incl. terminator).
+   Replies with an error itself; returns body length or -1. */
+static int form_recv_body(httpd_req_t *req, char *buf, size_t buf_size)
+{
+    if (req->content_len >= buf_size) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Request body too large");
+        return -1;
+    }
+
+    size_t got = 0;
+    int timeouts = 0;
+    int64_t start = esp_timer_get_time();
+    while (got < req->content_len) {
+        int ret = httpd_req_recv(req, buf + got, req->content_len - got);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            timeouts++;
+        } else if (ret <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Incomplete request body");
+            return -1;
+        } else {
+            got += (size_t)ret;
+        }
+        if (got < req->content_len &&
+            (timeouts > FORM_RECV_RETRIES || esp_timer_get_time() - start > FORM_RECV_MAX_US)) {
+            httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "Request body incomplete");
+            return -1;
+        }
+    }
+    buf[got] = '\0';
+    return (int)got;
+}
+
+/* HTML-escape src into dst (always terminated, truncated on overflow) */
+static void html_escape(char *dst, size_t dst_size, const char *src)
+{
+    size_t o = 0;
+    for (; *src; src++) {
+        const char *rep;
+        switch (*src) {
+        case '&':  rep = "&amp;";  break;
+        case '<':  rep = "&lt;";   break;
+        case '>':  rep = "&gt;";   break;
+        case '"':  rep = "&quot;"; break;
+        case '\'': rep = "&#39;";  break;
+        default:   rep = NULL;     break;
+        }
+        size_t n = rep ? strlen(rep) : 1;
+        if (o + n >= dst_size) break;
+        if (rep) memcpy(dst + o, rep, n);
+        else     dst[o] = *src;
+        o += n;
+    }
+    dst[o] = '\0';
+}
+
+/* html_escape() src onto a page in the HTML buffer, see html_buf_printf() */
+static void html_buf_escape(char *html, size_t *off, const char *src)
+{
+    if (*off >= CONFIG_IV3_HTML_BUF_SIZE) return;
+    html_escape(html + *off, CONFIG_IV3_HTML_BUF_SIZE - *off, src);
+    *off += strlen(html + *off);
+}
+
+/* JSON-escape src into dst; control characters are dropped */
+static void json_escape(char *dst, size_t dst_size, const char *src)
+{
+    size_t o = 0;
+    for (; *src; src++) {
+        unsigned char c = (unsigned char)*src;
+        if (c < 0x20) continue;
+        size_t n = (c == '"' || c == '\\') ? 2 : 1;
+        if (o + n >= dst_size) break;
+        if (n == 2) dst[o++] = '\\';
+        dst[o++] = (char)c;
+    }
+    dst[o] = '\0';
+}
+
+/* Root page: Status + AP IP address + some nice CSS */
+static esp_err_t root_get_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "HTTP: GET /");
 
-    // Fetch large HTML buffers from the heap (not the stack!)
-    const size_t HTML_BUF_SIZE = 4096;
-    char *html = malloc(HTML_BUF_SIZE);
+    // Large HTML buffer from the heap or .bss (not the stack!)
+    char *html = html_buf_alloc();
     if (!html) {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
         return ESP_FAIL;
@@ -577,6 +2083,36 @@ static esp_err_t root_get_handler(httpd_req_t *req)
     const char *mode_str = s_ap_mode ? "Access Point (Setup Mode)"
                                      : "Station (connected to Wi-Fi)";
 
+    char sched_str[64] = "No entries";
+    xSemaphoreTake(s_sched_lock, portMAX_DELAY);
+    if (s_sched_next != (time_t)-1 && s_sched_next_idx >= 0) {
+        time_t next = s_sched_next;
+        struct tm ntm;
+        localtime_r(&next, &ntm);
+        char when[24];
+        strftime(when, sizeof(when), "%a %H:%M", &ntm);
+        snprintf(sched_str, sizeof(sched_str), "Next: %s %s (%u entries)",
+                 when, sched_action_names[s_sched[s_sched_next_idx].action],
+                 (unsigned)s_sched_count);
+    } else if (s_sched_count) {
+        snprintf(sched_str, sizeof(sched_str), "%u entries, waiting for time",
+                 (unsigned)s_sched_count);
+    }
+    xSemaphoreGive(s_sched_lock);
+
+    char sync_str[96];
+    if (s_lansync.role == LANSYNC_FOLLOWER) {
+        snprintf(sync_str, sizeof(sync_str),
+                 "Follower of %08" PRIx32 ", offset %+.2f ms, phase error %+.2f ms",
+                 s_lansync.master_id,
+                 s_lansync.offset_us / 1000.0, s_lansync.phase_err_us / 1000.0);
+    } else if (s_lansync.role == LANSYNC_MASTER) {
+        snprintf(sync_str, sizeof(sync_str), "Master (%08" PRIx32 "), %" PRIu32 " beacons sent",
+                 s_lansync.node_id, s_lansync.beacons_tx);
+    } else {
+        snprintf(sync_str, sizeof(sync_str), "%s", lansync_role_str(s_lansync.role));
+    }
+
     char sta_ip_str[16] = "-";
     if (!s_ap_mode && s_sta_netif) {
         esp_netif_ip_info_t ip_info;
@@ -598,7 +2134,7 @@ static esp_err_t root_get_handler(httpd_req_t *req)
     }
 
 // Render HTML to the heap buffer
-    snprintf(html, HTML_BUF_SIZE,
+    int written = snprintf(html, CONFIG_IV3_HTML_BUF_SIZE,
         "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
         "<!--Copyright (c) 2025 Erik Lauter-->"
         "<title>Nixie Clock</title>"
@@ -632,9 +2168,15 @@ static esp_err_t root_get_handler(httpd_req_t *req)
         "<div class=\"value\"><code>%s</code></div>"
         "<div class=\"label\">Current time</div>"
         "<div class=\"value\">%s</div>"
+        "<div class=\"label\">LAN sync</div>"
+        "<div class=\"value\">%s</div>"
         "<div class=\"label\">Device IP</div>"
         "<div class=\"value\">%s</div>"
-        "<p style=\"margin-top:14px;\"><a href=\"/config\">WiFi &amp; Timezone Settings &raquo;</a></p>"
+        "<div class=\"label\">Schedule</div>"
+        "<div class=\"value\">%s</div>"
+        "<p style=\"margin-top:14px;\"><a href=\"/config\">WiFi &amp; Timezone Settings &raquo;</a><br>"
+        "<a href=\"/schedule\">Schedule &raquo;</a><br>"
+        "<a href=\"/chrono\">Stopwatch &amp; Countdown &raquo;</a></p>"
         "<div class=\"footer\">Copyright (c) 2025 Erik Lauter</div>"
         "</div></body></html>",
         mode_str,
@@ -642,63 +2184,35 @@ static esp_err_t root_get_handler(httpd_req_t *req)
         g_cfg.has_wifi ? g_cfg.ssid : "(not configured)",
         g_cfg.tz,
         time_str,
-        s_ap_mode ? g_ap_ip_str : sta_ip_str
+        sync_str,
+        s_ap_mode ? g_ap_ip_str : sta_ip_str,
+        sched_str
     );
 
+    html_buf_note(written);
+
     httpd_resp_set_type(req, "text/html");
     esp_err_t err = httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
 
-    free(html);
+    html_buf_free(html);
     return err;
 }
 
-/* Time zone options for dropdown */
-typedef struct {
-    const char *label;
-    const char *tz;
-} tz_option_t;
-
-static const tz_option_t tz_options[] = {
-    { "UTC", "UTC0" }, 
-    { "Europe - Berlin (CET/CEST)", "CET-1CEST,M3.5.0,M10.5.0/3" }, 
-    { "Europe - London", "GMT0BST,M3.5.0/1,M10.5.0" }, 
-    { "USA - Eastern (New York)", "EST5EDT,M3.2.0,M11.1.0" }, 
-    { "USA - Pacific (Los Angeles)", "PST8PDT,M3.2.0,M11.1.0" }, 
-    { "Japan (Tokyo)", "JST-9" }
-};
-static const size_t TZ_OPTION_COUNT = sizeof(tz_options)/sizeof(tz_options[0]);
 
 /* Configuration page (GET) with CSS + TZ dropdown */
 static esp_err_t config_get_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "HTTP: GET /config");
 
-    const size_t HTML_BUF_SIZE = 4096;
-    char *html = malloc(HTML_BUF_SIZE);
+    char *html = html_buf_alloc();
     if (!html) {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
         return ESP_FAIL;
     }
 
-    char tz_opts_html[512];
-    tz_opts_html[0] = '\0';
-
-    size_t offset = 0;
-    for (size_t i = 0; i < TZ_OPTION_COUNT; ++i) {
-        const char *sel = (strcmp(g_cfg.tz, tz_options[i].tz) == 0) ? " selected" : "";
-        int written = snprintf(tz_opts_html + offset,
-                               sizeof(tz_opts_html) - offset,
-                               "<option value=\"%s\"%s>%s</option>",
-                               tz_options[i].tz,
-                               sel,
-                               tz_options[i].label);
-        if (written < 0 || (size_t)written >= sizeof(tz_opts_html) - offset) {
-            break;
-        }
-        offset += (size_t)written;
-    }
-
-    snprintf(html, HTML_BUF_SIZE,
+    // Built in place: option lists and escaped fields go straight into the page
+    size_t off = 0;
+    html_buf_printf(html, &off,
         "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
         "<!--Copyright (c) 2025 Erik Lauter-->"
         "<title>Nixie Config</title>"
@@ -730,30 +2244,80 @@ static esp_err_t config_get_handler(httpd_req_t *req)
         "<h1>WiFi &amp; Time zone</h1>"
         "<form method=\"POST\" action=\"/config\">"
         "<label for=\"ssid\">WiFi SSID</label>"
-        "<input id=\"ssid\" name=\"ssid\" value=\"%s\">"
+        "<input id=\"ssid\" name=\"ssid\" list=\"ssid_list\" value=\"");
+    html_buf_escape(html, &off, g_cfg.has_wifi ? g_cfg.ssid : "");
+    html_buf_printf(html, &off, "\"><datalist id=\"ssid_list\">");
+
+    // SSID suggestions straight from the scan cache; never waits for a scan
+    xSemaphoreTake(s_scan_lock, portMAX_DELAY);
+    for (size_t i = 0; i < s_scan.count; ++i) {
+        const scan_net_t *n = &s_scan.nets[i];
+        html_buf_printf(html, &off, "<option value=\"");
+        html_buf_escape(html, &off, n->ssid);
+        html_buf_printf(html, &off, "\">%d dBm, ch %u, %s</option>",
+                        n->rssi, n->channel, wifi_auth_str(n->authmode));
+    }
+    size_t scan_count = s_scan.count;
+    uint32_t scan_ms = s_scan.duration_ms;
+    int32_t scan_age = wifi_scan_age_locked();
+    xSemaphoreGive(s_scan_lock);
+
+    html_buf_printf(html, &off, "</datalist><div class=\"small\">");
+    if (scan_age < 0) {
+        html_buf_printf(html, &off, "Scanning for networks&hellip; reload in a few seconds.");
+    } else {
+        html_buf_printf(html, &off, "%u networks, scanned %" PRId32 " s ago (%" PRIu32 " ms)",
+                        (unsigned)scan_count, scan_age, scan_ms);
+    }
+    if (scan_age < 0 || scan_age >= SCAN_STALE_S) {
+        wifi_scan_request();
+    }
+
+    html_buf_printf(html, &off,
+        "</div>"
         "<label for=\"password\">WiFi Password</label>"
-        "<input id=\"password\" type=\"password\" name=\"password\" value=\"%s\">"
+        "<input id=\"password\" type=\"password\" name=\"password\" value=\"");
+    html_buf_escape(html, &off, g_cfg.has_wifi ? g_cfg.password : "");
+    html_buf_printf(html, &off,
+        "\">"
         "<label for=\"tz\">Time zone</label>"
-        "<select id=\"tz\" name=\"tz\">"
-        "%s"
+        "<select id=\"tz\" name=\"tz\">");
+
+    for (size_t i = 0; i < TZ_OPTION_COUNT; ++i) {
+        const char *sel = (strcmp(g_cfg.tz, tz_options[i].tz) == 0) ? " selected" : "";
+        html_buf_printf(html, &off, "<option value=\"%s\"%s>%s</option>",
+                        tz_options[i].tz, sel, tz_options[i].label);
+    }
+
+    html_buf_printf(html, &off,
+        "</select>"
+        "<label for=\"lansync\">LAN time sync</label>"
+        "<select id=\"lansync\" name=\"lansync\">"
+        "<option value=\"0\"%s>Off (SNTP only)</option>"
+        "<option value=\"1\"%s>On (follow elected clock on this LAN)</option>"
         "</select>"
+        "<label for=\"rotation\">Display pages</label>"
+        "<input id=\"rotation\" name=\"rotation\" value=\"%s\">"
         "<div class=\"small\">"
-        ""
-        ""
+        "Base page, then <code>page@second+duration</code>. "
+        "Pages: time, time12, date, seconds, year, value, blank. "
+        "Example: <code>time,date@50+5,year@55+2</code>"
         "</div>"
         "<input type=\"submit\" value=\"Save &amp; Restart\">"
         "</form>"
         "<div class=\"back\"><a href=\"/\">&laquo; Zur&uuml;ck</a></div>"
         "</div></body></html>",
-        g_cfg.has_wifi ? g_cfg.ssid : "",
-        g_cfg.has_wifi ? g_cfg.password : "",
-        tz_opts_html
+        g_cfg.lan_sync ? "" : " selected",
+        g_cfg.lan_sync ? " selected" : "",
+        g_cfg.rotation
     );
 
+    html_buf_note(off > INT32_MAX ? INT32_MAX : (int)off);
+
     httpd_resp_set_type(req, "text/html");
     esp_err_t err = httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
 
-    free(html);
+    html_buf_free(html);
     return err;
 }
 
@@ -762,37 +2326,38 @@ static esp_err_t config_post_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "HTTP: POST /config");
 
-    char content[256];
-
-    int recv_len = MIN(req->content_len, sizeof(content) - 1);
-    int ret = httpd_req_recv(req, content, recv_len);
-    if (ret <= 0) {
+    char content[640];
+    int len = form_recv_body(req, content, sizeof(content));
+    if (len < 0) {
         return ESP_FAIL;
     }
-    content[recv_len] = '\0';
 
-    char ssid[32] = {0};
+    char ssid[33] = {0};
     char pass[64] = {0};
     char tz[32]   = {0};
-
-    char *rest = content;
-    char *token;
-    while ((token = strtok_r(rest, "&", &rest))) {
-        char *eq = strchr(token, '=');
-        if (!eq) continue;
-        *eq = '\0';
-        char *key = token;
-        char *val = eq + 1;
-
-        char decoded[128];
-        url_decode(decoded, val);
-
-        if (strcmp(key, "ssid") == 0) {
-            strncpy(ssid, decoded, sizeof(ssid) - 1);
-        } else if (strcmp(key, "password") == 0) {
-            strncpy(pass, decoded, sizeof(pass) - 1);
-        } else if (strcmp(key, "tz") == 0) {
-            strncpy(tz, decoded, sizeof(tz) - 1);
+    char lansync[2] = {0};
+    char rotation[64] = {0};
+
+    form_iter_t it;
+    form_field_t f;
+    form_iter_init(&it, content, (size_t)len);
+    while (form_next(&it, &f)) {
+        bool ok = true;
+        if (form_key_is(&f, "ssid")) {
+            ok = form_copy_val(ssid, sizeof(ssid), &f);
+        } else if (form_key_is(&f, "password")) {
+            ok = form_copy_val(pass, sizeof(pass), &f);
+        } else if (form_key_is(&f, "tz")) {
+            ok = form_copy_val(tz, sizeof(tz), &f);
+        } else if (form_key_is(&f, "lansync")) {
+            ok = form_copy_val(lansync, sizeof(lansync), &f);
+        } else if (form_key_is(&f, "rotation")) {
+            ok = form_copy_val(rotation, sizeof(rotation), &f);
+        }
+        if (!ok) {
+            ESP_LOGW(TAG, "HTTP: Feld '%s' zu lang (%u Bytes)", f.key, (unsigned)f.val_len);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Field too long");
+            return ESP_FAIL;
         }
     }
 
@@ -800,10 +2365,20 @@ static esp_err_t config_post_handler(httpd_req_t *req)
         strcpy(tz, "UTC0");
     }
 
+    if (rotation[0] == '\0') {
+        strcpy(rotation, "time");
+    }
+    if (!page_rotation_parse(rotation)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid display page list");
+        return ESP_FAIL;
+    }
+
     strncpy(g_cfg.ssid, ssid, sizeof(g_cfg.ssid) - 1);
     strncpy(g_cfg.password, pass, sizeof(g_cfg.password) - 1);
     strncpy(g_cfg.tz, tz, sizeof(g_cfg.tz) - 1);
     g_cfg.has_wifi = (g_cfg.ssid[0] != '\0');
+    g_cfg.lan_sync = (lansync[0] == '1');
+    strncpy(g_cfg.rotation, rotation, sizeof(g_cfg.rotation) - 1);
 
     config_save();
 
@@ -819,38 +2394,606 @@ static esp_err_t config_post_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+/* Schedule page (GET) */
+static esp_err_t schedule_get_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "HTTP: GET /schedule");
+
+    char *html = html_buf_alloc();
+    if (!html) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+
+    char lines[SCHED_MAX_ENTRIES * 32];
+    size_t off = 0;
+    lines[0] = '\0';
+
+    xSemaphoreTake(s_sched_lock, portMAX_DELAY);
+    for (size_t i = 0; i < s_sched_count; i++) {
+        int n = sched_format_entry(&s_sched[i], lines + off, sizeof(lines) - off - 1);
+        if (n < 0 || (size_t)n >= sizeof(lines) - off - 1) break;
+        off += (size_t)n;
+        lines[off++] = '\n';
+        lines[off]   = '\0';
+    }
+    xSemaphoreGive(s_sched_lock);
+
+    int written = snprintf(html, CONFIG_IV3_HTML_BUF_SIZE,
+        "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
+        "<!--Copyright (c) 2025 Erik Lauter-->"
+        "<title>Nixie Schedule</title>"
+        "<style>"
+        "body{margin:0;font-family:system-ui,-apple-system,BlinkMacSystemFont,"
+        "Segoe UI,sans-serif;background:#020617;color:#e5e7eb;"
+        "display:flex;align-items:center;justify-content:center;"
+        "min-height:100vh;padding:16px;box-sizing:border-box;}"
+        ".card{background:#020617;padding:24px 22px;border-radius:16px;"
+        "box-shadow:0 18px 45px rgba(0,0,0,0.6);max-width:440px;width:100%%;}"
+        "h1{margin:0 0 14px;font-size:1.5rem;color:#f9fafb;}"
+        "textarea{width:100%%;min-height:12em;padding:8px 10px;border-radius:10px;"
+        "border:1px solid #374151;background:#020617;color:#e5e7eb;"
+        "box-sizing:border-box;font-family:monospace;font-size:0.9rem;}"
+        "input[type=submit]{width:100%%;padding:8px 10px;margin-top:18px;background:#3b82f6;"
+        "border:none;color:#f9fafb;font-weight:600;cursor:pointer;border-radius:999px;}"
+        "input[type=submit]:hover{background:#2563eb;}"
+        ".back{margin-top:12px;font-size:0.85rem;}"
+        "a{color:#60a5fa;text-decoration:none;}"
+        "a:hover{text-decoration:underline;}"
+        ".small{font-size:0.75rem;color:#9ca3af;margin-top:8px;line-height:1.5;}"
+        "</style>"
+        "</head><body>"
+        "<div class=\"card\">"
+        "<h1>Schedule</h1>"
+        "<form method=\"POST\" action=\"/schedule\">"
+        "<textarea name=\"entries\" spellcheck=\"false\">%s</textarea>"
+        "<div class=\"small\">"
+        "One entry per line: <code>days HH:MM action [value]</code><br>"
+        "Days: <code>*</code>, <code>Mo-Fr</code>, <code>Sa,Su</code> ...<br>"
+        "Actions: <code>blank</code>, <code>wake</code>, "
+        "<code>brightness 0-8</code>, <code>alarm [minutes]</code><br>"
+        "Max. %d entries, local time."
+        "</div>"
+        "<input type=\"submit\" value=\"Save\">"
+        "</form>"
+        "<div class=\"back\"><a href=\"/\">&laquo; Zur&uuml;ck</a></div>"
+        "</div></body></html>",
+        lines,
+        SCHED_MAX_ENTRIES
+    );
+
+    html_buf_note(written);
+
+    httpd_resp_set_type(req, "text/html");
+    esp_err_t err = httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
+
+    html_buf_free(html);
+    return err;
+}
+
+/* Save schedule (POST) */
+static esp_err_t schedule_post_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "HTTP: POST /schedule");
+
+    char *body = html_buf_alloc();
+    if (!body) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+
+    sched_entry_t entries[SCHED_MAX_ENTRIES];
+    size_t count = 0;
+    char err_msg[48] = "";
+
+    int len = form_recv_body(req, body, CONFIG_IV3_HTML_BUF_SIZE);
+    if (len < 0) {
+        html_buf_free(body);
+        return ESP_FAIL;
+    }
+
+    form_iter_t it;
+    form_field_t f;
+    form_iter_init(&it, body, (size_t)len);
+    while (form_next(&it, &f)) {
+        if (!form_key_is(&f, "entries")) continue;
+
+        // Value is decoded in place and NUL-terminated, split it into lines
+        char *line = (char *)f.val;
+        for (int line_no = 1; line && !err_msg[0]; line_no++) {
+            char *nl = strchr(line, '\n');
+            if (nl) *nl = '\0';
+            char *cr = strchr(line, '\r');
+            if (cr) *cr = '\0';
+
+            while (*line == ' ' || *line == '\t') line++;
+            if (*line && *line != '#') {
+                if (count >= SCHED_MAX_ENTRIES) {
+                    snprintf(err_msg, sizeof(err_msg), "More than %d entries", SCHED_MAX_ENTRIES);
+                } else if (!sched_parse_line(line, &entries[count])) {
+                    snprintf(err_msg, sizeof(err_msg), "Line %d: invalid entry", line_no);
+                } else {
+                    count++;
+                }
+            }
+            line = nl ? nl + 1 : NULL;
+        }
+    }
+    html_buf_free(body);
+
+    if (err_msg[0]) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, err_msg);
+        return ESP_FAIL;
+    }
+
+    if (sched_replace(entries, count) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Saving schedule failed");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_status(req, "303 See Other");
+    httpd_resp_set_hdr(req, "Location", "/schedule");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+/* Display page statistics (GET /api/pages) */
+static esp_err_t api_pages_get_handler(httpd_req_t *req)
+{
+    char json[512];
+    int off = snprintf(json, sizeof(json), "{\"rotation\":\"%s\",\"pages\":[", g_cfg.rotation);
+
+    for (int i = 0; i < PAGE_COUNT && off > 0 && off < (int)sizeof(json); i++) {
+        off += snprintf(json + off, sizeof(json) - off,
+                        "%s{\"name\":\"%s\",\"commits\":%" PRIu32 "}",
+                        i ? "," : "", page_names[i], s_page_commits[i]);
+    }
+    if (off > 0 && off < (int)sizeof(json)) {
+        snprintf(json + off, sizeof(json) - off, "]}");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
+
+/* Set the value page (POST /api/value, body "v=12.34", empty clears) */
+static esp_err_t api_value_post_handler(httpd_req_t *req)
+{
+    char content[64];
+    int len = form_recv_body(req, content, sizeof(content));
+    if (len < 0) {
+        return ESP_FAIL;
+    }
+
+    char value[16] = {0};
+    form_iter_t it;
+    form_field_t f;
+    form_iter_init(&it, content, (size_t)len);
+    while (form_next(&it, &f)) {
+        if (form_key_is(&f, "v") && !form_copy_val(value, sizeof(value), &f)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Field too long");
+            return ESP_FAIL;
+        }
+    }
+
+    if (!page_value_set(value)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Up to 4 of 0-9, '-', ' ', each optionally followed by '.'");
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, "{\"ok\":true}");
+}
+
+/* Stopwatch / countdown page (GET /chrono) */
+static esp_err_t chrono_get_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "HTTP: GET /chrono");
+
+    char *html = html_buf_alloc();
+    if (!html) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+
+    int written = snprintf(html, CONFIG_IV3_HTML_BUF_SIZE,
+        "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
+        "<!--Copyright (c) 2025 Erik Lauter-->"
+        "<title>Nixie Stopwatch</title>"
+        "<style>"
+        "body{margin:0;font-family:system-ui,-apple-system,BlinkMacSystemFont,"
+        "Segoe UI,sans-serif;background:#020617;color:#e5e7eb;"
+        "display:flex;align-items:center;justify-content:center;"
+        "min-height:100vh;padding:16px;box-sizing:border-box;}"
+        ".card{background:#020617;padding:24px 22px;border-radius:16px;"
+        "box-shadow:0 18px 45px rgba(0,0,0,0.6);max-width:440px;width:100%%;}"
+        "h1{margin:0 0 14px;font-size:1.5rem;color:#f9fafb;}"
+        "label{display:block;margin-top:12px;font-size:0.8rem;"
+        "text-transform:uppercase;letter-spacing:0.08em;color:#9ca3af;}"
+        "input{width:100%%;padding:8px 10px;border-radius:10px;"
+        "border:1px solid #374151;background:#020617;color:#e5e7eb;"
+        "margin-top:4px;box-sizing:border-box;font-size:0.9rem;}"
+        "button{margin:12px 6px 0 0;padding:8px 14px;background:#3b82f6;border:none;"
+        "color:#f9fafb;font-weight:600;cursor:pointer;border-radius:999px;}"
+        "button:hover{background:#2563eb;}"
+        ".value{font-family:monospace;font-size:0.85rem;color:#9ca3af;margin-top:12px;}"
+        ".back{margin-top:12px;font-size:0.85rem;}"
+        "a{color:#60a5fa;text-decoration:none;}"
+        "a:hover{text-decoration:underline;}"
+        "</style>"
+        "</head><body>"
+        "<div class=\"card\">"
+        "<h1>Stopwatch &amp; Countdown</h1>"
+        "<form method=\"POST\" action=\"/api/chrono\">"
+        "<input type=\"hidden\" name=\"ui\" value=\"1\">"
+        "<button name=\"cmd\" value=\"stopwatch\">Stopwatch</button>"
+        "<button name=\"cmd\" value=\"start\">Start</button>"
+        "<button name=\"cmd\" value=\"stop\">Stop</button>"
+        "<button name=\"cmd\" value=\"reset\">Reset</button>"
+        "<button name=\"cmd\" value=\"off\">Clock</button>"
+        "<label for=\"secs\">Countdown (seconds)</label>"
+        "<input id=\"secs\" name=\"secs\" type=\"number\" min=\"1\" value=\"60\">"
+        "<button name=\"cmd\" value=\"countdown\">Set countdown</button>"
+        "</form>"
+        "<div class=\"value\">Status: <a href=\"/api/chrono\">/api/chrono</a></div>"
+        "<div class=\"back\"><a href=\"/\">&laquo; Zur&uuml;ck</a></div>"
+        "</div></body></html>"
+    );
+
+    html_buf_note(written);
+
+    httpd_resp_set_type(req, "text/html");
+    esp_err_t err = httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
+
+    html_buf_free(html);
+    return err;
+}
+
+/* Stopwatch / countdown status (GET /api/chrono) */
+static esp_err_t api_chrono_get_handler(httpd_req_t *req)
+{
+    char json[256];
+    chrono_status_json(json, sizeof(json));
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
+
+/* Stopwatch / countdown control (POST /api/chrono, cmd=...&secs=...) */
+static esp_err_t api_chrono_post_handler(httpd_req_t *req)
+{
+    char content[96];
+    int len = form_recv_body(req, content, sizeof(content));
+    if (len < 0) {
+        return ESP_FAIL;
+    }
+
+    char cmd[12]  = {0};
+    char secs[8]  = {0};
+    bool from_ui  = false;
+
+    form_iter_t it;
+    form_field_t f;
+    form_iter_init(&it, content, (size_t)len);
+    while (form_next(&it, &f)) {
+        bool ok = true;
+        if (form_key_is(&f, "cmd")) {
+            ok = form_copy_val(cmd, sizeof(cmd), &f);
+        } else if (form_key_is(&f, "secs")) {
+            ok = form_copy_val(secs, sizeof(secs), &f);
+        } else if (form_key_is(&f, "ui")) {
+            from_ui = true;
+        }
+        if (!ok) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Field too long");
+            return ESP_FAIL;
+        }
+    }
+
+    if (chrono_command(cmd, (uint32_t)strtoul(secs, NULL, 10)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                            "cmd: stopwatch, countdown (secs 1..356400), start, stop, reset, off");
+        return ESP_FAIL;
+    }
+
+    if (from_ui) {
+        httpd_resp_set_status(req, "303 See Other");
+        httpd_resp_set_hdr(req, "Location", "/chrono");
+        return httpd_resp_send(req, NULL, 0);
+    }
+    return api_chrono_get_handler(req);
+}
+
+/* Device status (GET /api/status) */
+static esp_err_t api_status_get_handler(httpd_req_t *req)
+{
+    char json[1280];   // eight incidents at their longest fit
+    int64_t now = esp_timer_get_time();
+
+    int off = snprintf(json, sizeof(json),
+        "{\"uptime_s\":%" PRId64 ",\"time_set\":%s,\"wifi_mode\":\"%s\","
+        "\"http\":{\"async\":%" PRIu32 ",\"inline\":%" PRIu32 "},"
+        "\"discovery\":{\"queries\":%" PRIu32 "},"
+        "\"lansync\":{\"role\":\"%s\",\"offset_us\":%" PRId32 ",\"phase_err_us\":%" PRId32 "},"
+        "\"mux\":{\"alarms\":%" PRIu32 ",\"late\":%" PRIu32 ",\"missed\":%" PRIu32 ","
+        "\"max_gap_us\":%" PRIu32 ",\"stalls\":%" PRIu32 ",\"restarts\":%" PRIu32 ","
+        "\"tube_faults\":%" PRIu32 ",\"tube_scans\":[%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "],"
+        "\"incidents_total\":%" PRIu32 ",\"incidents\":[",
+        now / 1000000, time_set ? "true" : "false", s_ap_mode ? "ap" : "sta",
+        s_http_async, s_http_inline,
+        s_disc_queries,
+        lansync_role_str(s_lansync.role), s_lansync.offset_us, s_lansync.phase_err_us,
+        s_mux_health.alarms, s_mux_health.late, s_mux_health.missed,
+        s_mux_health.max_gap_us, s_mux_stalls, s_mux_restarts,
+        s_mux_tube_faults,
+        s_mux_health.tube_scans[0], s_mux_health.tube_scans[1],
+        s_mux_health.tube_scans[2], s_mux_health.tube_scans[3],
+        s_mux_incident_count);
+
+    // Newest incident first
+    mux_incident_t incs[MUX_INCIDENTS];
+    portENTER_CRITICAL(&mux_health_mux);
+    uint32_t total = s_mux_incident_count;
+    memcpy(incs, s_mux_incidents, sizeof(incs));
+    portEXIT_CRITICAL(&mux_health_mux);
+
+    uint32_t n = MIN(total, (uint32_t)MUX_INCIDENTS);
+    for (uint32_t k = 0; k < n && off > 0 && off < (int)sizeof(json); k++) {
+        const mux_incident_t *inc = &incs[(total - 1 - k) % MUX_INCIDENTS];
+        off += snprintf(json + off, sizeof(json) - off,
+            "%s{\"age_ms\":%" PRId64 ",\"type\":\"%s\",\"tube\":%u,\"gap_us\":%" PRIu32 "}",
+            k ? "," : "", (now - inc->at_us) / 1000,
+            mux_incident_names[inc->type], inc->tube, inc->gap_us);
+    }
+    if (off > 0 && off < (int)sizeof(json)) {
+        snprintf(json + off, sizeof(json) - off, "]}}");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
+
+/* Wi-Fi scan cache (GET /api/scan) */
+static esp_err_t api_scan_get_handler(httpd_req_t *req)
+{
+    char json[1280];
+    char esc[2 * 32 + 1];
+
+    xSemaphoreTake(s_scan_lock, portMAX_DELAY);
+    int off = snprintf(json, sizeof(json),
+        "{\"age_s\":%" PRId32 ",\"duration_ms\":%" PRIu32 ",\"scans\":%" PRIu32 ","
+        "\"failures\":%" PRIu32 ",\"networks\":[",
+        wifi_scan_age_locked(), s_scan.duration_ms, s_scan.scans, s_scan.failures);
+    for (size_t i = 0; i < s_scan.count && off > 0 && off < (int)sizeof(json); i++) {
+        const scan_net_t *n = &s_scan.nets[i];
+        json_escape(esc, sizeof(esc), n->ssid);
+        off += snprintf(json + off, sizeof(json) - off,
+            "%s{\"ssid\":\"%s\",\"rssi\":%d,\"channel\":%u,\"auth\":\"%s\"}",
+            i ? "," : "", esc, n->rssi, n->channel, wifi_auth_str(n->authmode));
+    }
+    xSemaphoreGive(s_scan_lock);
+    if (off > 0 && off < (int)sizeof(json)) {
+        snprintf(json + off, sizeof(json) - off, "]}");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
+
+/* Request a rescan (POST /api/scan); rate-limited by the scan task */
+static esp_err_t api_scan_post_handler(httpd_req_t *req)
+{
+    wifi_scan_request();
+    httpd_resp_set_status(req, "202 Accepted");
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, "{\"queued\":true}");
+}
+
+/* Memory report (GET /api/mem) */
+static esp_err_t api_mem_get_handler(httpd_req_t *req)
+{
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+
+    size_t free_bytes = info.total_free_bytes;
+    unsigned frag_pct = free_bytes
+        ? (unsigned)(100 - (info.largest_free_block * 100) / free_bytes)
+        : 0;
+
+    char json[768];
+    int off = snprintf(json, sizeof(json),
+        "{\"static_alloc\":%s,"
+        "\"heap\":{\"free\":%u,\"min_free\":%u,\"largest_block\":%u,"
+        "\"allocated\":%u,\"fragmentation_pct\":%u},"
+        "\"html\":{\"buf_size\":%d,\"peak\":%u,\"truncated\":%" PRIu32 "},"
+        "\"tasks\":[",
+#ifdef CONFIG_IV3_STATIC_ALLOC
+        "true",
+#else
+        "false",
+#endif
+        (unsigned)free_bytes,
+        (unsigned)info.minimum_free_bytes,
+        (unsigned)info.largest_free_block,
+        (unsigned)info.total_allocated_bytes,
+        frag_pct,
+        CONFIG_IV3_HTML_BUF_SIZE,
+        (unsigned)s_html_peak,
+        s_html_truncated);
+
+    // Copy the list under the spinlock, scan the stacks outside it
+    // (interrupts stay enabled). s_mem_lock keeps every listed task
+    // alive until the scan is done, see mem_task_exit().
+    mem_task_t  tasks[MEM_MAX_TASKS];
+    UBaseType_t hwms[MEM_MAX_TASKS];
+    size_t      count;
+    xSemaphoreTake(s_mem_lock, portMAX_DELAY);
+    portENTER_CRITICAL(&s_mem_mux);
+    count = s_mem_task_count;
+    memcpy(tasks, s_mem_tasks, count * sizeof(tasks[0]));
+    portEXIT_CRITICAL(&s_mem_mux);
+    for (size_t i = 0; i < count; i++) hwms[i] = uxTaskGetStackHighWaterMark(tasks[i].handle);
+    xSemaphoreGive(s_mem_lock);
+
+    for (size_t i = 0; i < count && off > 0 && off < (int)sizeof(json); i++) {
+        off += snprintf(json + off, sizeof(json) - off,
+            "%s{\"name\":\"%s\",\"stack\":%" PRIu32 ",\"peak\":%" PRIu32 ",\"free_min\":%u}",
+            i ? "," : "",
+            tasks[i].name,
+            tasks[i].stack_size,
+            tasks[i].stack_size - (uint32_t)hwms[i],
+            (unsigned)hwms[i]);
+    }
+    if (off > 0 && off < (int)sizeof(json)) {
+        snprintf(json + off, sizeof(json) - off, "]}");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
+
+// httpd uses 3 lwIP sockets internally, LAN sync and discovery one each
+_Static_assert(CONFIG_IV3_HTTPD_MAX_SOCKETS + 5 <= CONFIG_LWIP_MAX_SOCKETS,
+               "IV3_HTTPD_MAX_SOCKETS + 5 must be <= LWIP_MAX_SOCKETS");
+
 /* Start HTTP server */
 static httpd_handle_t start_webserver(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.uri_match_fn = httpd_uri_match_wildcard;
+    config.stack_size   = CONFIG_IV3_HTTPD_TASK_STACK;
+    config.max_uri_handlers = 16;
+
+    // A tab that keeps idle sockets open must not lock out others:
+    // more sockets, a longer accept backlog, evict the least recently
+    // used socket when full, and drop dead peers via TCP keep-alive.
+    config.max_open_sockets  = CONFIG_IV3_HTTPD_MAX_SOCKETS;
+    config.backlog_conn      = 8;
+    config.lru_purge_enable  = true;
+    config.recv_wait_timeout = 3;
+    config.send_wait_timeout = 3;
+    config.keep_alive_enable   = true;
+    config.keep_alive_idle     = 5;
+    config.keep_alive_interval = 5;
+    config.keep_alive_count    = 3;
+
+    http_workers_start();
 
     httpd_handle_t server = NULL;
     if (httpd_start(&server, &config) == ESP_OK) {
         httpd_uri_t root_uri = {
             .uri      = "/",
             .method   = HTTP_GET,
-            .handler  = root_get_handler,
-            .user_ctx = NULL
+            .handler  = http_async_entry,
+            .user_ctx = (void *)root_get_handler
         };
         httpd_register_uri_handler(server, &root_uri);
 
         httpd_uri_t cfg_get_uri = {
             .uri      = "/config",
             .method   = HTTP_GET,
-            .handler  = config_get_handler,
-            .user_ctx = NULL
+            .handler  = http_async_entry,
+            .user_ctx = (void *)config_get_handler
         };
         httpd_register_uri_handler(server, &cfg_get_uri);
 
         httpd_uri_t cfg_post_uri = {
             .uri      = "/config",
             .method   = HTTP_POST,
-            .handler  = config_post_handler,
-            .user_ctx = NULL
+            .handler  = http_async_entry,
+            .user_ctx = (void *)config_post_handler
         };
         httpd_register_uri_handler(server, &cfg_post_uri);
 
+        httpd_uri_t sched_get_uri = {
+            .uri      = "/schedule",
+            .method   = HTTP_GET,
+            .handler  = http_async_entry,
+            .user_ctx = (void *)schedule_get_handler
+        };
+        httpd_register_uri_handler(server, &sched_get_uri);
+
+        httpd_uri_t sched_post_uri = {
+            .uri      = "/schedule",
+            .method   = HTTP_POST,
+            .handler  = http_async_entry,
+            .user_ctx = (void *)schedule_post_handler
+        };
+        httpd_register_uri_handler(server, &sched_post_uri);
+
+        httpd_uri_t api_pages_uri = {
+            .uri      = "/api/pages",
+            .method   = HTTP_GET,
+            .handler  = api_pages_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_pages_uri);
+
+        httpd_uri_t api_value_uri = {
+            .uri      = "/api/value",
+            .method   = HTTP_POST,
+            .handler  = api_value_post_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_value_uri);
+
+        httpd_uri_t chrono_uri = {
+            .uri      = "/chrono",
+            .method   = HTTP_GET,
+            .handler  = http_async_entry,
+            .user_ctx = (void *)chrono_get_handler
+        };
+        httpd_register_uri_handler(server, &chrono_uri);
+
+        httpd_uri_t api_chrono_get_uri = {
+            .uri      = "/api/chrono",
+            .method   = HTTP_GET,
+            .handler  = api_chrono_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_chrono_get_uri);
+
+        httpd_uri_t api_chrono_post_uri = {
+            .uri      = "/api/chrono",
+            .method   = HTTP_POST,
+            .handler  = api_chrono_post_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_chrono_post_uri);
+
+        httpd_uri_t api_status_uri = {
+            .uri      = "/api/status",
+            .method   = HTTP_GET,
+            .handler  = api_status_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_status_uri);
+
+        httpd_uri_t api_mem_uri = {
+            .uri      = "/api/mem",
+            .method   = HTTP_GET,
+            .handler  = api_mem_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_mem_uri);
+
+        httpd_uri_t api_scan_get_uri = {
+            .uri      = "/api/scan",
+            .method   = HTTP_GET,
+            .handler  = api_scan_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_scan_get_uri);
+
+        httpd_uri_t api_scan_post_uri = {
+            .uri      = "/api/scan",
+            .method   = HTTP_POST,
+            .handler  = api_scan_post_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_scan_post_uri);
+
+        // httpd creates its own task; track it by name
+        mem_register_task("httpd", xTaskGetHandle("httpd"), config.stack_size);
+
         ESP_LOGI(TAG, "HTTP-Server gestartet.");
     } else {
         ESP_LOGE(TAG, "HTTP-Server konnte nicht gestartet werden.");
@@ -858,6 +3001,60 @@ static httpd_handle_t start_webserver(void)
     return server;
 }
 
+/* ------------------------------------------------------------
+   Serial console
+   ------------------------------------------------------------ */
+
+static int console_chrono_cmd(int argc, char **argv)
+{
+    if (argc >= 2) {
+        uint32_t secs = (argc >= 3) ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+        if (chrono_command(argv[1], secs) != ESP_OK) {
+            printf("usage: chrono <stopwatch|countdown SECS|start|stop|reset|off>\n");
+            return 1;
+        }
+    }
+
+    char json[256];
+    chrono_status_json(json, sizeof(json));
+    printf("%s\n", json);
+    return 0;
+}
+
+static void console_start(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "iv3>";
+
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&hw_config, &repl_config, &repl));
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl));
+#elif defined(CONFIG_ESP_CONSOLE_USB_CDC)
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl));
+#else
+    ESP_LOGW(TAG, "Keine Konsole konfiguriert.");
+    return;
+#endif
+
+    esp_console_register_help_command();
+
+    const esp_console_cmd_t chrono_cmd = {
+        .command = "chrono",
+        .help    = "Stopwatch/countdown: stopwatch | countdown SECS | start | stop | reset | off (no argument: status)",
+        .func    = &console_chrono_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&chrono_cmd));
+
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    // The REPL task is heap-allocated by esp_console; track it by name
+    mem_register_task("console_repl", xTaskGetHandle("console_repl"), repl_config.task_stack_size);
+}
+
 /* ------------------------------------------------------------
    app_main
    ------------------------------------------------------------ */
@@ -870,7 +3067,9 @@ void app_main(void)
         ESP_ERROR_CHECK(nvs_flash_init());
     }
 
+    mem_init();
     config_load();
+    sched_start();
 
     // Set time zone (for localtime_r)
     setenv("TZ", g_cfg.tz, 1);
@@ -879,7 +3078,9 @@ void app_main(void)
     // Advertisement
     init_gpios();
     init_timer_500hz();
-    xTaskCreate(display_task, "display_task", 4096, NULL, 9, NULL);
+    mux_monitor_start();
+    MEM_TASK_CREATE(display_task, "display_task", CONFIG_IV3_DISPLAY_TASK_STACK, 9);
+    chrono_start();
 
     // WiFi + network
     wifi_init_all();
@@ -897,6 +3098,7 @@ void app_main(void)
 
         if (bits & WIFI_CONNECTED_BIT) {
             ESP_LOGI(TAG, "Mit WLAN verbunden, HTTP-Server im STA-Modus.");
+            if (g_cfg.lan_sync) lansync_start();
         } else {
             ESP_LOGW(TAG, "WLAN-STA fehlgeschlagen, starte SoftAP.");
             esp_wifi_stop();
@@ -907,7 +3109,10 @@ void app_main(void)
         wifi_start_ap();
     }
 
+    wifi_scan_start();
+    discovery_start();
     s_http_server = start_webserver();
+    console_start();
 
     ESP_LOGI(TAG, "Clock gestartet. Web-UI aufrufen zum Konfigurieren.");
 }
@@ -0,0 +1,57 @@
+/* ------------------------------------------------------------
+   Multiplex scan
+
+   The GPTimer alarm fires every MUX_PERIOD_US and lights the
+   next tube, so one scan over all four tubes takes
+   MUX_SCAN_US = 8 ms (125 Hz). At the start of each scan the
+   ISR copies the whole frame from tube_list, so a scan never
+   mixes two frames. frame_commit() bumps a sequence number with
+   every new frame; the latch compares it with the last one it
+   took and counts the frames it never got to show. A frame that
+   stays in tube_list for at least one scan is always shown,
+   which the 10 ms chrono frames do with 2 ms of timer jitter
+   to spare.
+
+   Header-only so that the ISR inlines it into IRAM and the host
+   simulation (Firmware/test/host/test_mux_scan.c) runs the same
+   code.
+   ------------------------------------------------------------ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MUX_PERIOD_US 2000
+#define MUX_TUBES     4
+#define MUX_SCAN_US   (MUX_TUBES * MUX_PERIOD_US)
+
+#ifndef MUX_INLINE
+#define MUX_INLINE static inline __attribute__((always_inline))
+#endif
+
+typedef struct {
+    uint8_t  cur_tube;     // tube lit by the last alarm
+    uint32_t seen_seq;     // frame sequence number of the last latch
+    uint32_t latched;      // frames shown for at least one scan
+    uint32_t dropped;      // frames replaced before any scan started
+} mux_scan_t;
+
+#define MUX_SCAN_INIT { .cur_tube = MUX_TUBES - 1 }
+
+/* Advance to the next tube; true if a scan starts and the frame
+   should be latched */
+MUX_INLINE bool mux_scan_next(mux_scan_t *s)
+{
+    s->cur_tube = (uint8_t)((s->cur_tube + 1) % MUX_TUBES);
+    return s->cur_tube == 0;
+}
+
+/* Account a latch of frame number seq */
+MUX_INLINE void mux_scan_latch(mux_scan_t *s, uint32_t seq)
+{
+    uint32_t n = seq - s->seen_seq;   // wraps safely
+    if (n == 0) return;
+    s->latched++;
+    s->dropped += n - 1;
+    s->seen_seq = seq;
+}
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "sched.h"
+
+const char *const sched_action_names[SCHED_ACT_COUNT] = {
+    "blank", "wake", "brightness", "alarm"
+};
+
+/* Monday first, as users write it; values are tm_wday */
+static const char *const sched_day_names[7] = { "Mo", "Tu", "We", "Th", "Fr", "Sa", "Su" };
+static const uint8_t     sched_day_wday[7]  = { 1, 2, 3, 4, 5, 6, 0 };
+
+bool sched_entry_valid(const sched_entry_t *e)
+{
+    if (!e->days || (e->days & ~SCHED_ALL_DAYS)) return false;
+    if (e->hour > 23 || e->minute > 59) return false;
+    if (e->action >= SCHED_ACT_COUNT) return false;
+    if (e->action == SCHED_ACT_BRIGHTNESS && e->arg > SCHED_BRIGHTNESS_MAX) return false;
+    if (e->action == SCHED_ACT_ALARM && e->arg > SCHED_ALARM_MAX_MIN) return false;
+    return true;
+}
+
+/* Local wall time as one number that sorts like the calendar (minutes) */
+static int64_t local_key(const struct tm *t, int hour, int min)
+{
+    return ((((int64_t)t->tm_year * 12 + t->tm_mon) * 32 + t->tm_mday) * 24 + hour) * 60 + min;
+}
+
+static int64_t local_key_at(time_t t)
+{
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return local_key(&tm, tm.tm_hour, tm.tm_min);
+}
+
+/* Occurrence of e on the day base + day_offset, -1 if e does not run that day */
+static time_t sched_at(const struct tm *base, int day_offset, const sched_entry_t *e)
+{
+    // Date and weekday of that day (noon is never inside a DST change)
+    struct tm day = *base;
+    day.tm_mday  += day_offset;
+    day.tm_hour   = 12;
+    day.tm_min    = 0;
+    day.tm_sec    = 0;
+    day.tm_isdst  = -1;
+    if (mktime(&day) == (time_t)-1) return (time_t)-1;
+    if (!(e->days & (1u << day.tm_wday))) return (time_t)-1;
+
+    // HH:MM under either offset; keep what really reads HH:MM locally.
+    // Both do in the autumn overlap, and the earlier one wins.
+    int64_t want = local_key(&day, e->hour, e->minute);
+    time_t best = (time_t)-1;
+    for (int dst = -1; dst <= 1; dst++) {
+        struct tm t = day;
+        t.tm_hour  = e->hour;
+        t.tm_min   = e->minute;
+        t.tm_isdst = dst;
+        time_t r = mktime(&t);
+        if (r == (time_t)-1) continue;
+        struct tm chk;
+        localtime_r(&r, &chk);
+        if (chk.tm_sec == 0 && local_key(&chk, chk.tm_hour, chk.tm_min) == want &&
+            (best == (time_t)-1 || r < best)) {
+            best = r;
+        }
+    }
+    if (best != (time_t)-1) return best;
+
+    // Skipped by the spring gap: first instant at or after HH:MM
+    struct tm t = day;
+    t.tm_hour  = e->hour;
+    t.tm_min   = e->minute;
+    t.tm_isdst = -1;
+    time_t guess = mktime(&t);
+    time_t lo = guess - 6 * 3600, hi = guess + 6 * 3600;
+    if (local_key_at(lo) >= want || local_key_at(hi) < want) return (time_t)-1;
+    while (hi - lo > 1) {
+        time_t mid = lo + (hi - lo) / 2;
+        if (local_key_at(mid) >= want) hi = mid;
+        else                           lo = mid;
+    }
+    return hi;
+}
+
+time_t sched_next_after(const sched_entry_t *e, time_t now)
+{
+    struct tm base;
+    localtime_r(&now, &base);
+    for (int d = 0; d <= 7; d++) {
+        time_t t = sched_at(&base, d, e);
+        if (t != (time_t)-1 && t > now) return t;
+    }
+    return (time_t)-1;
+}
+
+time_t sched_last_at_or_before(const sched_entry_t *e, time_t now)
+{
+    struct tm base;
+    localtime_r(&now, &base);
+    for (int d = 0; d >= -7; d--) {
+        time_t t = sched_at(&base, d, e);
+        if (t != (time_t)-1 && t <= now) return t;
+    }
+    return (time_t)-1;
+}
+
+void sched_state_at(const sched_entry_t *entries, size_t count, time_t now, sched_state_t *st)
+{
+    st->blank      = -1;
+    st->blank_at   = (time_t)-1;
+    st->brightness = -1;
+    st->brightness_at = (time_t)-1;
+
+    for (size_t i = 0; i < count; i++) {
+        const sched_entry_t *e = &entries[i];
+        if (e->action == SCHED_ACT_ALARM) continue;
+        time_t prev = sched_last_at_or_before(e, now);
+        if (prev == (time_t)-1) continue;
+
+        // Ties go to the later entry, which is also the one firing applies last
+        if (e->action == SCHED_ACT_BRIGHTNESS) {
+            if (prev >= st->brightness_at) { st->brightness_at = prev; st->brightness = (int)i; }
+        } else if (prev >= st->blank_at) {
+            st->blank_at = prev; st->blank = (int)i;
+        }
+    }
+}
+
+size_t sched_rebase(const sched_entry_t *entries, size_t count, time_t now,
+                    time_t *due, size_t *late, time_t *late_at)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].action == SCHED_ACT_ALARM && due[i] != (time_t)-1 && due[i] <= now) {
+            late[n]    = i;
+            late_at[n] = due[i];
+            n++;
+        }
+        due[i] = sched_next_after(&entries[i], now);
+    }
+    return n;
+}
+
+/* "Mo-Fr", "Sa,Su", "*" */
+static void sched_format_days(uint8_t days, char *out, size_t out_size)
+{
+    if ((days & SCHED_ALL_DAYS) == SCHED_ALL_DAYS) {
+        snprintf(out, out_size, "*");
+        return;
+    }
+    size_t off = 0;
+    out[0] = '\0';
+    for (int i = 0; i < 7; ) {
+        if (!(days & (1u << sched_day_wday[i]))) { i++; continue; }
+        int j = i;
+        while (j + 1 < 7 && (days & (1u << sched_day_wday[j + 1]))) j++;
+        int n;
+        if (j - i >= 2) n = snprintf(out + off, out_size - off, "%s%s-%s", off ? "," : "", sched_day_names[i], sched_day_names[j]);
+        else if (j > i) n = snprintf(out + off, out_size - off, "%s%s,%s", off ? "," : "", sched_day_names[i], sched_day_names[j]);
+        else            n = snprintf(out + off, out_size - off, "%s%s", off ? "," : "", sched_day_names[i]);
+        if (n < 0 || (size_t)n >= out_size - off) return;
+        off += (size_t)n;
+        i = j + 1;
+    }
+}
+
+static int sched_day_index(const char *name, size_t len)
+{
+    if (len != 2) return -1;
+    for (int i = 0; i < 7; i++) {
+        if (strncasecmp(name, sched_day_names[i], 2) == 0) return i;
+    }
+    return -1;
+}
+
+/* Parse a day spec; returns mask or 0 on error */
+static uint8_t sched_parse_days(const char *spec)
+{
+    if (strcmp(spec, "*") == 0) return SCHED_ALL_DAYS;
+
+    uint8_t mask = 0;
+    while (*spec) {
+        const char *end = strchr(spec, ',');
+        size_t len = end ? (size_t)(end - spec) : strlen(spec);
+        const char *dash = memchr(spec, '-', len);
+
+        int from = sched_day_index(spec, dash ? (size_t)(dash - spec) : len);
+        int to   = dash ? sched_day_index(dash + 1, len - (size_t)(dash - spec) - 1) : from;
+        if (from < 0 || to < 0) return 0;
+
+        for (int i = from; ; i = (i + 1) % 7) {   // ranges may wrap (Sa-Mo)
+            mask |= (uint8_t)(1u << sched_day_wday[i]);
+            if (i == to) break;
+        }
+        spec += len;
+        if (*spec == ',') spec++;
+    }
+    return mask;
+}
+
+bool sched_parse_line(const char *line, sched_entry_t *e)
+{
+    char days[32], act[16];
+    unsigned h, m, a = 0;
+    int n = sscanf(line, "%31s %u:%u %15s %u", days, &h, &m, act, &a);
+    if (n < 4 || h > 23 || m > 59 || a > 255) return false;
+
+    e->days   = sched_parse_days(days);
+    e->hour   = (uint8_t)h;
+    e->minute = (uint8_t)m;
+    e->arg    = (uint8_t)a;
+
+    e->action = SCHED_ACT_COUNT;
+    for (int i = 0; i < SCHED_ACT_COUNT; i++) {
+        if (strcasecmp(act, sched_action_names[i]) == 0) e->action = (uint8_t)i;
+    }
+    if (e->action == SCHED_ACT_BRIGHTNESS && n < 5) return false;
+    return sched_entry_valid(e);
+}
+
+int sched_format_entry(const sched_entry_t *e, char *out, size_t out_size)
+{
+    char days[32];
+    sched_format_days(e->days, days, sizeof(days));
+    if (e->action == SCHED_ACT_BRIGHTNESS || (e->action == SCHED_ACT_ALARM && e->arg)) {
+        return snprintf(out, out_size, "%s %02u:%02u %s %u", days, e->hour, e->minute,
+                        sched_action_names[e->action], e->arg);
+    }
+    return snprintf(out, out_size, "%s %02u:%02u %s", days, e->hour, e->minute,
+                    sched_action_names[e->action]);
+}
@@ -0,0 +1,75 @@
+/* ------------------------------------------------------------
+   Schedule entries (night blanking, LED brightness, alarms)
+
+   Entries repeat weekly: a weekday mask plus local HH:MM. This
+   file holds the entry format, its text form for the web UI and
+   the occurrence arithmetic; sched_task in main.c owns the table,
+   NVS and the actions. Pure C on top of mktime()/localtime_r(),
+   so the host tests run it against a brute-force oracle.
+
+   Across DST changes an entry fires once per matching day: at the
+   first instant whose local time is HH:MM or later. A time that
+   is skipped in spring fires at the end of the gap, a time that
+   repeats in autumn fires on its first pass only.
+   ------------------------------------------------------------ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define SCHED_MAX_ENTRIES 16
+#define SCHED_ALL_DAYS    0x7F
+
+typedef enum {
+    SCHED_ACT_BLANK = 0,     // tubes off
+    SCHED_ACT_WAKE,          // tubes on
+    SCHED_ACT_BRIGHTNESS,    // LED brightness, arg 0..8
+    SCHED_ACT_ALARM,         // flash display for arg minutes
+    SCHED_ACT_COUNT
+} sched_action_t;
+
+#define SCHED_BRIGHTNESS_MAX 8
+#define SCHED_ALARM_MAX_MIN  240
+
+typedef struct __attribute__((packed)) {
+    uint8_t days;       // bit n = tm_wday n (bit0 = Sunday)
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t action;     // sched_action_t
+    uint8_t arg;
+} sched_entry_t;       // stored as-is in NVS blob "sched"
+
+/* Entries that decide the current state at some instant (replayed
+   after boot, schedule edits and clock steps); -1 = none */
+typedef struct {
+    int    blank;           // latest blank/wake entry
+    time_t blank_at;
+    int    brightness;      // latest brightness entry
+    time_t brightness_at;
+} sched_state_t;
+
+extern const char *const sched_action_names[SCHED_ACT_COUNT];
+
+/* Range check of every field, also for blobs read back from NVS */
+bool sched_entry_valid(const sched_entry_t *e);
+
+/* Next occurrence strictly after now / latest at or before now; -1 if none */
+time_t sched_next_after(const sched_entry_t *e, time_t now);
+time_t sched_last_at_or_before(const sched_entry_t *e, time_t now);
+
+void sched_state_at(const sched_entry_t *entries, size_t count, time_t now, sched_state_t *st);
+
+/* Recompute every due time for now when sched_task was woken for a
+   resync (clock stepped, time set) instead of firing. due[i] holds
+   the previous due time, -1 = none. sched_state_at() restores blank
+   and brightness, but an alarm that fell due before the wake-up would
+   be lost: those are listed in late[] with their due time in
+   late_at[] so the caller fires them once. Returns their number. */
+size_t sched_rebase(const sched_entry_t *entries, size_t count, time_t now,
+                    time_t *due, size_t *late, time_t *late_at);
+
+/* One line: "<days> HH:MM <action> [arg]", days "Mo-Fr", "Sa,Su" or "*" */
+bool sched_parse_line(const char *line, sched_entry_t *e);
+int  sched_format_entry(const sched_entry_t *e, char *out, size_t out_size);
@@ -0,0 +1,11 @@
+#include "tz_options.h"
+
+const tz_option_t tz_options[] = {
+    { "UTC", "UTC0" },
+    { "Europe - Berlin (CET/CEST)", "CET-1CEST,M3.5.0,M10.5.0/3" },
+    { "Europe - London", "GMT0BST,M3.5.0/1,M10.5.0" },
+    { "USA - Eastern (New York)", "EST5EDT,M3.2.0,M11.1.0" },
+    { "USA - Pacific (Los Angeles)", "PST8PDT,M3.2.0,M11.1.0" },
+    { "Japan (Tokyo)", "JST-9" }
+};
+const size_t TZ_OPTION_COUNT = sizeof(tz_options)/sizeof(tz_options[0]);
@@ -0,0 +1,15 @@
+/* ------------------------------------------------------------
+   Time zones offered on /config (POSIX TZ strings). The host
+   replay (Firmware/test/host/replay_display.c) sweeps every entry.
+   ------------------------------------------------------------ */
+#pragma once
+
+#include <stddef.h>
+
+typedef struct {
+    const char *label;
+    const char *tz;
+} tz_option_t;
+
+extern const tz_option_t tz_options[];
+extern const size_t      TZ_OPTION_COUNT;
@@ -0,0 +1,34 @@
+/* Minimal assertion helpers for the host tests */
+#pragma once
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            check_failures++;                                                   \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_STR(a, b)                                                         \
+    do {                                                                        \
+        const char *a_ = (a), *b_ = (b);                                        \
+        if (strcmp(a_, b_) != 0) {                                              \
+            fprintf(stderr, "%s:%d: CHECK failed: \"%s\" != \"%s\"\n",          \
+                    __FILE__, __LINE__, a_, b_);                                \
+            check_failures++;                                                   \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_DONE()                                                            \
+    do {                                                                        \
+        if (check_failures) {                                                   \
+            fprintf(stderr, "%d check(s) failed\n", check_failures);            \
+            return 1;                                                           \
+        }                                                                       \
+        printf("ok\n");                                                         \
+        return 0;                                                               \
+    } while (0)
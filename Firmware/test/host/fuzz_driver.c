@@ -0,0 +1,90 @@
+/* Stand-alone driver for LLVMFuzzerTestOneInput() when libFuzzer is
+   not available (e.g. gcc). Runs the files given on the command line,
+   then -runs=N random inputs biased towards the target's syntax
+   (mutations of a small seed set plus fresh random strings).
+
+   fuzz_xxx [-runs=N] [-seed=S] [-max_len=M] [file...] */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint64_t s_rng = 0x9e3779b97f4a7c15ull;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (uint32_t)(s_rng >> 16);
+}
+
+/* Characters that matter to most of the firmware's parsers */
+static const char s_alphabet[] = "%+&=,.@:-_ 0123456789abcdefABCDEFxyz\0\r\n/";
+
+static size_t gen(uint8_t *buf, size_t max_len, const uint8_t *prev, size_t prev_len)
+{
+    size_t len;
+    if (prev_len && rnd() % 2) {
+        // Mutate the previous input: flip, insert, delete or splice bytes
+        len = prev_len;
+        memcpy(buf, prev, len);
+        int edits = 1 + rnd() % 4;
+        while (edits--) {
+            size_t at = len ? rnd() % len : 0;
+            switch (rnd() % 4) {
+            case 0: if (len) buf[at] = (uint8_t)s_alphabet[rnd() % (sizeof(s_alphabet) - 1)]; break;
+            case 1: if (len) buf[at] = (uint8_t)rnd(); break;
+            case 2: if (len < max_len) { memmove(buf + at + 1, buf + at, len - at); buf[at] = (uint8_t)s_alphabet[rnd() % (sizeof(s_alphabet) - 1)]; len++; } break;
+            case 3: if (len) { memmove(buf + at, buf + at + 1, len - at - 1); len--; } break;
+            }
+        }
+        return len;
+    }
+    len = rnd() % (max_len + 1);
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (rnd() % 8) ? (uint8_t)s_alphabet[rnd() % (sizeof(s_alphabet) - 1)] : (uint8_t)rnd();
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long runs = 100000;
+    size_t max_len = 256;
+    int files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoul(argv[i] + 6, NULL, 10);
+        } else if (strncmp(argv[i], "-seed=", 6) == 0) {
+            s_rng = strtoull(argv[i] + 6, NULL, 10) * 0x9e3779b97f4a7c15ull + 1;
+        } else if (strncmp(argv[i], "-max_len=", 9) == 0) {
+            max_len = strtoul(argv[i] + 9, NULL, 10);
+        } else {
+            FILE *fp = fopen(argv[i], "rb");
+            if (!fp) { perror(argv[i]); return 1; }
+            static uint8_t data[1 << 16];
+            size_t n = fread(data, 1, sizeof(data), fp);
+            fclose(fp);
+            LLVMFuzzerTestOneInput(data, n);
+            files++;
+        }
+    }
+
+    uint8_t *a = malloc(max_len + 1), *b = malloc(max_len + 1);
+    if (!a || !b) return 1;
+    size_t prev_len = 0;
+    for (unsigned long r = 0; r < runs; r++) {
+        size_t len = gen(a, max_len, b, prev_len);
+        LLVMFuzzerTestOneInput(a, len);
+        memcpy(b, a, len);
+        prev_len = len;
+    }
+    printf("%d file(s), %lu random input(s) ok\n", files, runs);
+    free(a);
+    free(b);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* Fuzz target for form_next() + form_copy_val().
+
+   Every field must lie inside the input buffer, be NUL-terminated,
+   and match a straightforward reference decoder; form_copy_val()
+   must either copy exactly or refuse without touching dst. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "form.h"
+
+#define FUZZ_CHECK(cond) \
+    do { if (!(cond)) { fprintf(stderr, "fuzz_form: %s failed\n", #cond); abort(); } } while (0)
+
+static int hexval(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* Reference: decode [s, s+n) into a fresh buffer */
+static size_t ref_decode(const uint8_t *s, size_t n, char *out)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '%' && i + 2 < n &&
+            hexval(s[i + 1]) >= 0 && hexval(s[i + 2]) >= 0) {
+            out[o++] = (char)(hexval(s[i + 1]) * 16 + hexval(s[i + 2]));
+            i += 2;
+        } else {
+            out[o++] = (s[i] == '+') ? ' ' : (char)s[i];
+        }
+    }
+    return o;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    char *buf = malloc(size + 1);
+    char *ref = malloc(size + 1);
+    FUZZ_CHECK(buf && ref);
+    memcpy(buf, data, size);
+
+    form_iter_t it;
+    form_field_t f;
+    form_iter_init(&it, buf, size);
+
+    size_t pos = 0;   // start of the next pair in the original input
+    while (form_next(&it, &f)) {
+        FUZZ_CHECK(f.key >= buf && f.key + f.key_len <= buf + size);
+        FUZZ_CHECK(f.val >= buf && f.val + f.val_len <= buf + size);
+        FUZZ_CHECK(f.key[f.key_len] == '\0' && f.val[f.val_len] == '\0');
+
+        // Locate the same pair in the original input and decode it independently
+        while (pos < size && data[pos] == '&') pos++;
+        size_t end = pos;
+        while (end < size && data[end] != '&') end++;
+        size_t eq = pos;
+        while (eq < end && data[eq] != '=') eq++;
+
+        size_t n = ref_decode(data + pos, eq - pos, ref);
+        FUZZ_CHECK(n == f.key_len && memcmp(ref, f.key, n) == 0);
+        n = (eq < end) ? ref_decode(data + eq + 1, end - eq - 1, ref) : 0;
+        FUZZ_CHECK(n == f.val_len && memcmp(ref, f.val, n) == 0);
+        pos = end;
+
+        char small[9], big[256];
+        memset(small, 'x', sizeof(small));
+        bool fits = f.val_len < sizeof(small) && !memchr(f.val, '\0', f.val_len);
+        bool ok = form_copy_val(small, sizeof(small), &f);
+        FUZZ_CHECK(ok == fits);
+        FUZZ_CHECK(!ok || (strlen(small) == f.val_len && memcmp(small, f.val, f.val_len) == 0));
+        for (size_t i = 0; !ok && i < sizeof(small); i++) FUZZ_CHECK(small[i] == 'x');
+        (void)form_copy_val(big, sizeof(big), &f);
+        (void)form_key_is(&f, "ssid");
+    }
+    while (pos < size && data[pos] == '&') pos++;
+    FUZZ_CHECK(pos == size);   // every non-empty pair was returned
+
+    free(buf);
+    free(ref);
+    return 0;
+}
@@ -0,0 +1,406 @@
+/* Fast-forward replay of the display logic across every time zone
+   on /config.
+
+   A virtual clock walks each year in the range: a coarse pass every
+   --step seconds, plus every second within 90 s of each DST change
+   and of the local midnights around New Year and Feb 28/29/Mar 1.
+   Each instant is shown at both blink phases. The firmware path is
+   the one display_task runs: localtime_r() with the zone's POSIX TZ,
+   then display_render() with a rotation parsed by rotation_parse().
+
+   The oracle shares no code with it: its own POSIX TZ parser and
+   M-rule evaluation, days/civil conversion, and page-per-second
+   tables written out by hand for each rotation. Every frame is
+   diffed tube by tube; the replay rate is reported at the end.
+
+   replay_display [--from YEAR] [--to YEAR] [--step SECS] [--zone N] [--quiet]
+     defaults: 2024..2031, step 61 s (walks through every second of
+     the minute), all zones. Exit status 1 on any diff.
+*/
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "display_pages.h"
+#include "tz_options.h"
+
+#define DENSE_S   90
+#define MAX_DIFFS 20
+
+/* ---- oracle: calendar ---------------------------------------------------- */
+
+/* Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant) */
+static int64_t days_from_civil(int64_t y, int m, int d)
+{
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(int64_t z, int *y, int *m, int *d)
+{
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp  = (5 * doy + 2) / 153;
+    *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+static int weekday(int64_t days)   // 0 = Sunday; 1970-01-01 was a Thursday
+{
+    int64_t w = (days + 4) % 7;
+    return (int)(w < 0 ? w + 7 : w);
+}
+
+static int days_in_month(int y, int m)
+{
+    static const int dim[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return (m == 2 && leap) ? 29 : dim[m - 1];
+}
+
+/* ---- oracle: POSIX TZ ---------------------------------------------------- */
+
+typedef struct {
+    int month, week, wday;   // Mm.w.d
+    int32_t time;            // seconds after local midnight, may be <0 or >24h
+} tz_rule_t;
+
+typedef struct {
+    int32_t   std_west;      // seconds west of UTC (POSIX sign)
+    int32_t   dst_west;
+    bool      has_dst;
+    tz_rule_t start, end;
+} tz_spec_t;
+
+static const char *tz_name(const char *p)
+{
+    if (*p == '<') {
+        const char *q = strchr(p, '>');
+        return q ? q + 1 : NULL;
+    }
+    const char *q = p;
+    while (isalpha((unsigned char)*q)) q++;
+    return (q - p >= 3) ? q : NULL;
+}
+
+/* [+-]hh[:mm[:ss]] */
+static const char *tz_hms(const char *p, int32_t *out)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-') sign = (*p++ == '-') ? -1 : 1;
+    if (!isdigit((unsigned char)*p)) return NULL;
+    int32_t v[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++) {
+        while (isdigit((unsigned char)*p)) v[i] = v[i] * 10 + (*p++ - '0');
+        if (*p != ':' || i == 2) break;
+        p++;
+    }
+    *out = sign * (v[0] * 3600 + v[1] * 60 + v[2]);
+    return p;
+}
+
+static const char *tz_rule(const char *p, tz_rule_t *r)
+{
+    if (*p++ != 'M') return NULL;   // Jn and n forms are not used on /config
+    if (sscanf(p, "%d.%d.%d", &r->month, &r->week, &r->wday) != 3) return NULL;
+    while (*p && *p != '/' && *p != ',') p++;
+    r->time = 7200;
+    if (*p == '/') p = tz_hms(p + 1, &r->time);
+    return p;
+}
+
+static bool tz_parse(const char *s, tz_spec_t *tz)
+{
+    memset(tz, 0, sizeof(*tz));
+    const char *p = tz_name(s);
+    if (!p || !(p = tz_hms(p, &tz->std_west))) return false;
+    if (!*p) return true;
+
+    tz->has_dst  = true;
+    tz->dst_west = tz->std_west - 3600;
+    if (!(p = tz_name(p))) return false;
+    if (*p && *p != ',' && !(p = tz_hms(p, &tz->dst_west))) return false;
+    if (*p++ != ',' || !(p = tz_rule(p, &tz->start))) return false;
+    if (*p++ != ',' || !(p = tz_rule(p, &tz->end))) return false;
+    return *p == '\0';
+}
+
+/* UTC instant of a rule in year y; the rule time counts in the offset before the change */
+static int64_t tz_rule_utc(const tz_rule_t *r, int y, int32_t west_before)
+{
+    int64_t first = days_from_civil(y, r->month, 1);
+    int mday = 1 + (r->wday - weekday(first) + 7) % 7 + 7 * (r->week - 1);
+    while (mday > days_in_month(y, r->month)) mday -= 7;
+    return (days_from_civil(y, r->month, mday)) * 86400 + r->time + west_before;
+}
+
+static void tz_changes(const tz_spec_t *tz, int y, int64_t *start, int64_t *end)
+{
+    *start = tz_rule_utc(&tz->start, y, tz->std_west);
+    *end   = tz_rule_utc(&tz->end,   y, tz->dst_west);
+}
+
+static int32_t tz_west_at(const tz_spec_t *tz, int64_t t)
+{
+    if (!tz->has_dst) return tz->std_west;
+    int y, m, d;
+    civil_from_days(t >= 0 ? t / 86400 : (t - 86399) / 86400, &y, &m, &d);
+    int64_t start, end;
+    tz_changes(tz, y, &start, &end);
+    bool dst = (start < end) ? (t >= start && t < end) : (t >= start || t < end);
+    return dst ? tz->dst_west : tz->std_west;
+}
+
+typedef struct {
+    int year, mon, mday, hour, min, sec;   // mon 1..12
+} civil_t;
+
+static civil_t oracle_local(const tz_spec_t *tz, int64_t t)
+{
+    int64_t l = t - tz_west_at(tz, t);
+    int64_t days = (l >= 0) ? l / 86400 : (l - 86399) / 86400;
+    int64_t sod = l - days * 86400;
+    civil_t c;
+    civil_from_days(days, &c.year, &c.mon, &c.mday);
+    c.hour = (int)(sod / 3600);
+    c.min  = (int)(sod / 60 % 60);
+    c.sec  = (int)(sod % 60);
+    return c;
+}
+
+/* ---- oracle: frames ------------------------------------------------------ */
+
+typedef struct {
+    const char *spec;   // handed to rotation_parse()
+    const char *map;    // page per second of the minute, written out by hand
+} rotation_case_t;
+
+/* t=time T=time12 d=date s=seconds y=year v=value b=blank */
+static const rotation_case_t rotations[] = {
+    { "time,date@50+5",
+      "tttttttttt" "tttttttttt" "tttttttttt" "tttttttttt" "tttttttttt" "dddddttttt" },
+    { "time12,seconds@58+4,year@0+2,date@50+5",
+      "ssTTTTTTTT" "TTTTTTTTTT" "TTTTTTTTTT" "TTTTTTTTTT" "TTTTTTTTTT" "dddddTTTss" },
+    { "year,value@10+20,blank@45+15",
+      "yyyyyyyyyy" "vvvvvvvvvv" "vvvvvvvvvv" "yyyyyyyyyy" "yyyyybbbbb" "bbbbbbbbbb" },
+};
+#define ROTATION_CASES (sizeof(rotations) / sizeof(rotations[0]))
+
+static void put(frame_t *f, int pos, char tens, char ones)
+{
+    f->digit[pos]     = (tens == ' ') ? GLYPH_BLANK : (uint8_t)(tens - '0');
+    f->digit[pos + 1] = (uint8_t)(ones - '0');
+}
+
+static frame_t oracle_frame(char page, const civil_t *c, long usec)
+{
+    frame_t f;
+    char s[16];
+    uint8_t blink = usec < 500000 ? HIGH : LOW;
+    memset(f.dot, LOW, sizeof(f.dot));
+    switch (page) {
+    case 't':
+        snprintf(s, sizeof(s), "%02d%02d", c->hour, c->min);
+        put(&f, 0, s[0], s[1]); put(&f, 2, s[2], s[3]);
+        f.dot[1] = blink;
+        break;
+    case 'T': {
+        int h12 = c->hour == 0 ? 12 : c->hour > 12 ? c->hour - 12 : c->hour;
+        snprintf(s, sizeof(s), "%2d%02d", h12, c->min);
+        put(&f, 0, s[0], s[1]); put(&f, 2, s[2], s[3]);
+        f.dot[1] = blink;
+        f.dot[3] = c->hour >= 12 ? HIGH : LOW;
+        break;
+    }
+    case 'd':
+        snprintf(s, sizeof(s), "%02d%02d", c->mday, c->mon);
+        put(&f, 0, s[0], s[1]); put(&f, 2, s[2], s[3]);
+        memset(f.dot, blink, sizeof(f.dot));
+        break;
+    case 's':
+        snprintf(s, sizeof(s), "%02d%02d", c->min, c->sec);
+        put(&f, 0, s[0], s[1]); put(&f, 2, s[2], s[3]);
+        f.dot[1] = HIGH;
+        break;
+    case 'y':
+        snprintf(s, sizeof(s), "%04d", c->year);
+        put(&f, 0, s[0], s[1]); put(&f, 2, s[2], s[3]);
+        break;
+    case 'v':   // no value posted: hyphens
+        memset(f.digit, GLYPH_HYPHEN, sizeof(f.digit));
+        break;
+    default:
+        memset(f.digit, GLYPH_BLANK, sizeof(f.digit));
+        break;
+    }
+    return f;
+}
+
+/* ---- replay -------------------------------------------------------------- */
+
+typedef struct {
+    uint64_t frames;
+    uint64_t diffs;
+    uint64_t virtual_s;
+} totals_t;
+
+typedef struct {
+    const tz_option_t *zone;
+    tz_spec_t          tz;
+    rotation_t         rot[ROTATION_CASES];
+    totals_t          *tot;
+    bool               quiet;
+} replay_t;
+
+static void fmt_frame(const frame_t *f, char *out)
+{
+    static const char glyph[] = "0123456789- ";
+    for (int i = 0; i < 4; i++) {
+        *out++ = glyph[f->digit[i] < 12 ? f->digit[i] : 10];
+        *out++ = f->dot[i] ? '.' : ' ';
+    }
+    *out = '\0';
+}
+
+static void replay_instant(replay_t *r, int64_t t)
+{
+    civil_t c = oracle_local(&r->tz, t);
+
+    struct timeval tv = { .tv_sec = (time_t)t };
+    struct tm tmv;
+    localtime_r(&tv.tv_sec, &tmv);
+
+    for (size_t k = 0; k < ROTATION_CASES; k++) {
+        display_state_t st = { .time_set = true, .rotation = &r->rot[k] };
+        for (int phase = 0; phase < 2; phase++) {
+            tv.tv_usec = phase ? 500000 : 0;
+            frame_t got, want = oracle_frame(rotations[k].map[c.sec], &c, tv.tv_usec);
+            display_render(&st, &tv, &tmv, &got);
+            r->tot->frames++;
+            if (memcmp(&got, &want, sizeof(got)) == 0) continue;
+
+            if (r->tot->diffs++ < MAX_DIFFS && !r->quiet) {
+                char g[9], w[9];
+                fmt_frame(&got, g);
+                fmt_frame(&want, w);
+                fprintf(stderr, "%s: t=%lld (%04d-%02d-%02d %02d:%02d:%02d%s) rotation \"%s\": got [%s] want [%s]\n",
+                        r->zone->label, (long long)t, c.year, c.mon, c.mday, c.hour, c.min, c.sec,
+                        phase ? ".5" : "", rotations[k].spec, g, w);
+            }
+        }
+    }
+}
+
+static void replay_window(replay_t *r, int64_t center)
+{
+    for (int64_t t = center - DENSE_S; t <= center + DENSE_S; t++) replay_instant(r, t);
+}
+
+/* UTC instant of local midnight starting y-m-d */
+static int64_t local_midnight(const tz_spec_t *tz, int y, int m, int d)
+{
+    int64_t l = days_from_civil(y, m, d) * 86400;
+    int64_t t = l + tz->std_west;
+    if (t - tz_west_at(tz, t) != l) t = l + tz->dst_west;
+    return t;
+}
+
+static void replay_zone(replay_t *r, int from, int to, int step)
+{
+    int64_t start = days_from_civil(from, 1, 1) * 86400;
+    int64_t end   = days_from_civil(to + 1, 1, 1) * 86400;
+
+    setenv("TZ", r->zone->tz, 1);
+    tzset();
+
+    for (int64_t t = start; t < end; t += step) replay_instant(r, t);
+
+    for (int y = from; y <= to; y++) {
+        if (r->tz.has_dst) {
+            int64_t on, off;
+            tz_changes(&r->tz, y, &on, &off);
+            replay_window(r, on);
+            replay_window(r, off);
+        }
+        replay_window(r, local_midnight(&r->tz, y, 1, 1));
+        replay_window(r, local_midnight(&r->tz, y, 2, 28));
+        replay_window(r, local_midnight(&r->tz, y, 3, 1));
+        if (days_in_month(y, 2) == 29) replay_window(r, local_midnight(&r->tz, y, 2, 29));
+    }
+    r->tot->virtual_s += (uint64_t)(end - start);
+}
+
+int main(int argc, char **argv)
+{
+    int from = 2024, to = 2031, step = 61, zone = -1;
+    bool quiet = false;
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--from") && i + 1 < argc) from = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--to")   && i + 1 < argc) to   = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--step") && i + 1 < argc) step = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--zone") && i + 1 < argc) zone = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--quiet")) quiet = true;
+        else {
+            fprintf(stderr, "usage: %s [--from YEAR] [--to YEAR] [--step SECS] [--zone N] [--quiet]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (step < 1 || to < from) return 2;
+
+    for (size_t k = 0; k < ROTATION_CASES; k++) {
+        if (strlen(rotations[k].map) != 60) {
+            fprintf(stderr, "rotation map %zu is not 60 seconds long\n", k);
+            return 2;
+        }
+    }
+
+    totals_t all = { 0 };
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (size_t z = 0; z < TZ_OPTION_COUNT; z++) {
+        if (zone >= 0 && (size_t)zone != z) continue;
+        replay_t r = { .zone = &tz_options[z], .quiet = quiet };
+        totals_t tot = { 0 };
+        r.tot = &tot;
+        if (!tz_parse(r.zone->tz, &r.tz)) {
+            fprintf(stderr, "%s: oracle cannot parse TZ \"%s\"\n", r.zone->label, r.zone->tz);
+            all.diffs++;
+            continue;
+        }
+        for (size_t k = 0; k < ROTATION_CASES; k++) {
+            if (!rotation_parse(rotations[k].spec, &r.rot[k])) {
+                fprintf(stderr, "rotation_parse(\"%s\") failed\n", rotations[k].spec);
+                return 2;
+            }
+        }
+
+        replay_zone(&r, from, to, step);
+        printf("%-30s %-28s %10llu frames %6llu diffs\n", r.zone->label, r.zone->tz,
+               (unsigned long long)tot.frames, (unsigned long long)tot.diffs);
+        all.frames    += tot.frames;
+        all.diffs     += tot.diffs;
+        all.virtual_s += tot.virtual_s;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (wall <= 0) wall = 1e-9;
+    printf("%d..%d, step %d s + %d s windows: %llu frames, %llu diffs in %.2f s "
+           "(%.2f M frames/s, %.1f virtual years/s)\n",
+           from, to, step, DENSE_S, (unsigned long long)all.frames, (unsigned long long)all.diffs,
+           wall, (double)all.frames / wall / 1e6, (double)all.virtual_s / (365.2425 * 86400) / wall);
+    return all.diffs ? 1 : 0;
+}
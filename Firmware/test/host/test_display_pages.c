@@ -0,0 +1,161 @@
+/* Display page selection and parsing (display_pages.c).
+
+   Rotation specs accept exactly the pages offered on /config, the
+   value page parser right-aligns and rejects malformed input, and
+   display_render() applies its overrides in order: no time yet,
+   alarm flash, night blanking, rotation. The stopwatch frame is
+   checked at its format boundaries.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "display_pages.h"
+#include "check.h"
+
+static void frame_str(const frame_t *f, char *out)
+{
+    static const char glyph[] = "0123456789- ";
+    for (int i = 0; i < 4; i++) {
+        *out++ = f->digit[i] < 12 ? glyph[f->digit[i]] : '?';
+        if (f->dot[i]) *out++ = '.';
+    }
+    *out = '\0';
+}
+
+static void test_rotation_parse(void)
+{
+    static const char *const ok[] = {
+        "time", "time12,date@50+5", "year,value@10+20,blank@45+15", "seconds,time@0+60",
+        "date@58+4", "",
+    };
+    static const char *const bad[] = {
+        "chrono", "none", "time,chrono@10+5", "time,none@0+1", "time,date", "date@60+1",
+        "date@0+0", "date@0+61", "date@5", "date@5+1x", "clock",
+        "t,a@1+1,b@1+1,c@1+1,d@1+1,e@1+1,f@1+1,g@1+1",
+        "time,date@1+1,date@2+1,date@3+1,date@4+1,date@5+1,date@6+1,date@7+1",
+    };
+    rotation_t r;
+    for (size_t i = 0; i < sizeof(ok) / sizeof(ok[0]); i++) {
+        if (!rotation_parse(ok[i], &r)) {
+            fprintf(stderr, "rejected \"%s\"\n", ok[i]);
+            check_failures++;
+        }
+    }
+    rotation_t keep = { .base = PAGE_YEAR, .count = 0 };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        r = keep;
+        if (rotation_parse(bad[i], &r) || r.base != PAGE_YEAR) {
+            fprintf(stderr, "accepted \"%s\"\n", bad[i]);
+            check_failures++;
+        }
+    }
+
+    // Slots wrap the minute; the first matching slot wins
+    CHECK(rotation_parse("time,date@58+4,year@0+5", &r));
+    CHECK(rotation_page_for_second(&r, 57) == PAGE_TIME);
+    CHECK(rotation_page_for_second(&r, 58) == PAGE_DATE);
+    CHECK(rotation_page_for_second(&r, 1)  == PAGE_DATE);
+    CHECK(rotation_page_for_second(&r, 2)  == PAGE_YEAR);
+    CHECK(rotation_page_for_second(&r, 5)  == PAGE_TIME);
+}
+
+static void test_value_parse(void)
+{
+    static const struct { const char *in, *frame; } ok[] = {
+        { "1234", "1234" }, { "12.34", "12.34" }, { "-5", "  -5" }, { " 7.5", "  7.5" },
+        { "1.2.3.4.", "1.2.3.4." }, { "", "    " }, { "---", " ---" },
+    };
+    static const char *const bad[] = { "12345", ".1", "a", "12:34", "1.2.3.4.5" };
+    frame_t f;
+    bool nonempty;
+    char s[16];
+    for (size_t i = 0; i < sizeof(ok) / sizeof(ok[0]); i++) {
+        CHECK(page_value_parse(ok[i].in, &f, &nonempty));
+        CHECK(nonempty == (ok[i].in[0] != '\0'));
+        frame_str(&f, s);
+        CHECK_STR(s, ok[i].frame);
+    }
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (page_value_parse(bad[i], &f, &nonempty)) {
+            fprintf(stderr, "accepted value \"%s\"\n", bad[i]);
+            check_failures++;
+        }
+    }
+}
+
+static void test_overrides(void)
+{
+    rotation_t r;
+    CHECK(rotation_parse("time,value@10+5", &r));
+    frame_t value = { .digit = { 4, 2, GLYPH_BLANK, 7 }, .dot = { 0, 1, 0, 0 } };
+    display_state_t st = { .time_set = true, .rotation = &r, .value = &value };
+
+    struct tm tmv = { .tm_year = 127, .tm_mon = 2, .tm_mday = 9, .tm_hour = 7, .tm_min = 5, .tm_sec = 3 };
+    struct timeval tv = { .tv_sec = 1000, .tv_usec = 100000 };
+    frame_t f;
+    char s[16];
+
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_TIME);
+    frame_str(&f, s);
+    CHECK_STR(s, "07.05");
+    tv.tv_usec = 600000;
+    display_render(&st, &tv, &tmv, &f);
+    frame_str(&f, s);
+    CHECK_STR(s, "0705");
+
+    tmv.tm_sec = 12;
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_VALUE);
+    frame_str(&f, s);
+    CHECK_STR(s, "42. 7");
+    st.value = NULL;
+    display_render(&st, &tv, &tmv, &f);
+    frame_str(&f, s);
+    CHECK_STR(s, "----");
+
+    // Night blanking beats the rotation, the alarm beats blanking
+    st.blank = true;
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_BLANK);
+    frame_str(&f, s);
+    CHECK_STR(s, "    ");
+    st.alarm_until = tv.tv_sec + 1;
+    tv.tv_usec = 100000;
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_TIME);
+    tv.tv_usec = 700000;
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_BLANK);
+    tv.tv_sec = st.alarm_until;
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_BLANK);
+
+    // No time yet beats everything
+    st.time_set = false;
+    tv.tv_sec = 0;
+    CHECK(display_render(&st, &tv, &tmv, &f) == PAGE_NONE);
+    frame_str(&f, s);
+    CHECK_STR(s, "----");
+}
+
+static void test_chrono(void)
+{
+    static const struct { int64_t cs; const char *frame; } cases[] = {
+        { 0, "00.00" }, { 5999, "59.99" }, { 6000, "01.00" }, { 599999, "99.59" },
+        { 600000, "01.40" }, { 360000 * 100 + 6000, "00.01" },
+    };
+    frame_t f;
+    char s[16];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        chrono_render(cases[i].cs, false, &f);
+        frame_str(&f, s);
+        CHECK_STR(s, cases[i].frame);
+    }
+    chrono_render(1234, true, &f);
+    frame_str(&f, s);
+    CHECK_STR(s, "    ");
+}
+
+int main(void)
+{
+    test_rotation_parse();
+    test_value_parse();
+    test_overrides();
+    test_chrono();
+    CHECK_DONE();
+}
@@ -0,0 +1,81 @@
+#include <string.h>
+#include "form.h"
+#include "check.h"
+
+/* Decode body, return the n-th field (0-based) copied into key/val */
+static int field(const char *body, int n, char *key, char *val)
+{
+    static char buf[512];
+    size_t len = strlen(body);
+    memcpy(buf, body, len);
+    form_iter_t it;
+    form_field_t f;
+    form_iter_init(&it, buf, len);
+    int i = 0;
+    while (form_next(&it, &f)) {
+        if (i++ == n) {
+            memcpy(key, f.key, f.key_len); key[f.key_len] = '\0';
+            memcpy(val, f.val, f.val_len); val[f.val_len] = '\0';
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int count(const char *body)
+{
+    char key[512], val[512];
+    int n = 0;
+    while (field(body, n, key, val)) n++;
+    return n;
+}
+
+int main(void)
+{
+    char k[512], v[512];
+
+    CHECK(field("ssid=My+Net&password=p%40ss", 0, k, v));
+    CHECK_STR(k, "ssid"); CHECK_STR(v, "My Net");
+    CHECK(field("ssid=My+Net&password=p%40ss", 1, k, v));
+    CHECK_STR(k, "password"); CHECK_STR(v, "p@ss");
+
+    // Malformed escapes pass through unchanged
+    CHECK(field("a=%zz%4", 0, k, v));   CHECK_STR(v, "%zz%4");
+    CHECK(field("a=100%", 0, k, v));    CHECK_STR(v, "100%");
+    CHECK(field("a=%41%61", 0, k, v));  CHECK_STR(v, "Aa");
+
+    // Encoded separators stay inside the value
+    CHECK(field("tz=CET-1CEST%2CM3.5.0%2CM10.5.0%2F3&x=1", 0, k, v));
+    CHECK_STR(v, "CET-1CEST,M3.5.0,M10.5.0/3");
+    CHECK(field("a=%26%3D", 0, k, v));  CHECK_STR(v, "&=");
+
+    // Empty pairs are skipped, missing '=' means empty value
+    CHECK(count("&&a=1&&b&") == 2);
+    CHECK(field("&&a=1&&b&", 1, k, v)); CHECK_STR(k, "b"); CHECK_STR(v, "");
+    CHECK(count("") == 0);
+    CHECK(field("=x", 0, k, v));        CHECK_STR(k, ""); CHECK_STR(v, "x");
+
+    // form_copy_val: exact fit, too long, embedded NUL
+    char buf[64];
+    form_iter_t it;
+    form_field_t f;
+    char dst[5] = "keep";
+
+    strcpy(buf, "a=1234&b=12345&c=1%002");
+    form_iter_init(&it, buf, strlen(buf));
+    CHECK(form_next(&it, &f) && form_key_is(&f, "a"));
+    CHECK(form_copy_val(dst, sizeof(dst), &f));  CHECK_STR(dst, "1234");
+    CHECK(form_next(&it, &f) && form_key_is(&f, "b"));
+    CHECK(!form_copy_val(dst, sizeof(dst), &f)); CHECK_STR(dst, "1234");
+    CHECK(form_next(&it, &f) && form_key_is(&f, "c") && f.val_len == 3);
+    CHECK(!form_copy_val(dst, sizeof(dst), &f));
+    CHECK(!form_next(&it, &f));
+
+    // A 32-byte SSID fits a 33-byte field
+    strcpy(buf, "ssid=0123456789abcdef0123456789abcdef");
+    form_iter_init(&it, buf, strlen(buf));
+    char ssid[33];
+    CHECK(form_next(&it, &f) && form_copy_val(ssid, sizeof(ssid), &f));
+
+    CHECK_DONE();
+}
@@ -0,0 +1,213 @@
+/* LAN sync with several instances on loopback.
+
+   Each node runs the real state machine (lansync.c) with its own
+   UDP socket bound to the same port and broadcasts beacons to
+   127.255.255.255, like clocks on one subnet. Every node has a
+   virtual wall clock with its own start offset and oscillator
+   error; step() jumps it, slew() corrects it gradually like
+   adjtime(). Virtual time runs SPEED times faster than real time.
+
+   Scenario:
+     t=0   ids 0x30, 0x20, 0x40 (SNTP synced, tens of ms apart) and
+           0x08 (no SNTP, never set) start
+     t=5s  0x10 boots synced while 0x20 is master
+     t=16s end: 0x10 must be the only master, everyone follows it
+           within 1 ms, 0x08 follows without claiming.
+
+   test_lansync_loopback [port] */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lansync.h"
+#include "check.h"
+
+#define SPEED       2
+#define NODES       5
+#define END_US      16000000LL
+#define ADJ_RATE    6           // adjtime slews at 1/6 of elapsed time
+
+typedef struct {
+    uint32_t id;
+    int64_t  boot_us;           // virtual start time
+    double   offset_us;         // initial wall offset against true time
+    double   ppm;               // oscillator error
+    int      has_source;        // "SNTP" answered
+
+    int      running;
+    int      sock;
+    double   wall;              // virtual wall clock, us
+    double   slew_left;         // pending adjtime correction
+    int64_t  last_mono;
+    int64_t  next_sec;
+    int      time_valid;
+    int      source_on;
+    lansync_state_t st;
+    lansync_clock_t clk;
+} node_t;
+
+static int64_t s_t0;
+static int64_t s_frozen = -1;   // >= 0: virtual time stands still (measurement)
+
+/* True virtual time in us */
+static int64_t vnow(void)
+{
+    if (s_frozen >= 0) return s_frozen;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec - s_t0) / 1000 * SPEED;
+}
+
+static void advance(node_t *n)
+{
+    int64_t now = vnow();
+    double dt = (double)(now - n->last_mono);
+    n->last_mono = now;
+    n->wall += dt * (1.0 + n->ppm * 1e-6);
+    double max = dt / ADJ_RATE;
+    double s = n->slew_left;
+    if (s > max) s = max;
+    if (s < -max) s = -max;
+    n->wall += s;
+    n->slew_left -= s;
+}
+
+static int64_t clk_mono(void *ctx) { return vnow(); }
+static int64_t clk_wall(void *ctx) { node_t *n = ctx; advance(n); return (int64_t)n->wall; }
+static void clk_step(void *ctx, int64_t d) { node_t *n = ctx; advance(n); n->wall += d; n->time_valid = 1; }
+static bool clk_slew(void *ctx, int32_t d) { node_t *n = ctx; advance(n); n->slew_left = d; return true; }
+static void clk_source(void *ctx, bool on) { ((node_t *)ctx)->source_on = on; }
+
+static uint16_t s_port = 42321;
+
+static void node_boot(node_t *n)
+{
+    n->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int yes = 1;
+    setsockopt(n->sock, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+    setsockopt(n->sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons(s_port),
+                             .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(n->sock, (struct sockaddr *)&a, sizeof(a)) < 0) { perror("bind"); exit(1); }
+
+    n->last_mono = vnow();
+    n->wall = (double)n->last_mono + 1.7e15 + n->offset_us;
+    n->time_valid = n->has_source;
+    n->source_on = 1;
+    n->clk = (lansync_clock_t){ clk_mono, clk_wall, clk_step, clk_slew, clk_source, n };
+    lansync_init(&n->st, n->id, &n->clk);
+    n->next_sec = clk_wall(n) / 1000000 + 1;
+    n->running = 1;
+}
+
+static lansync_local_t local_of(node_t *n)
+{
+    return (lansync_local_t){ .time_valid = n->time_valid, .has_source = n->has_source };
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) s_port = (uint16_t)atoi(argv[1]);
+
+    node_t nodes[NODES] = {
+        { .id = 0x30, .boot_us = 0,       .offset_us = +35000,  .ppm = +40, .has_source = 1 },
+        { .id = 0x20, .boot_us = 0,       .offset_us = -20000,  .ppm = -25, .has_source = 1 },
+        { .id = 0x40, .boot_us = 0,       .offset_us = +60000,  .ppm = +10, .has_source = 1 },
+        { .id = 0x08, .boot_us = 0,       .offset_us = -9.0e14, .ppm = -50, .has_source = 0 },
+        { .id = 0x10, .boot_us = 5000000, .offset_us = -45000,  .ppm = +30, .has_source = 1 },
+    };
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    s_t0 = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+    struct sockaddr_in bcast = { .sin_family = AF_INET, .sin_port = htons(s_port) };
+    inet_pton(AF_INET, "127.255.255.255", &bcast.sin_addr);
+
+    int claimed_by_10 = 0, yielded_20 = 0;
+
+    while (vnow() < END_US) {
+        // Boot nodes that are due, find the next second boundary
+        int64_t wait = 50000;
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        int maxfd = -1;
+        for (int i = 0; i < NODES; i++) {
+            node_t *n = &nodes[i];
+            if (!n->running && vnow() >= n->boot_us) node_boot(n);
+            if (!n->running) continue;
+            int64_t w = n->next_sec * 1000000LL - clk_wall(n);
+            if (w < wait) wait = w < 0 ? 0 : w;
+            FD_SET(n->sock, &rfds);
+            if (n->sock > maxfd) maxfd = n->sock;
+        }
+
+        struct timeval tv = { 0, (suseconds_t)(wait / SPEED) };
+        if (maxfd >= 0 && select(maxfd + 1, &rfds, NULL, NULL, &tv) > 0) {
+            for (int i = 0; i < NODES; i++) {
+                node_t *n = &nodes[i];
+                if (!n->running || !FD_ISSET(n->sock, &rfds)) continue;
+                lansync_pkt_t pkt;
+                int len = (int)recv(n->sock, &pkt, sizeof(pkt), 0);
+                lansync_local_t local = local_of(n);
+                unsigned ev = lansync_on_packet(&n->st, &n->clk, &local, &pkt, len, clk_wall(n));
+                if (n->id == 0x20 && (ev & LANSYNC_EV_YIELDED)) yielded_20 = 1;
+                if (n->id == 0x10 && (ev & LANSYNC_EV_CLAIMED)) claimed_by_10 = 1;
+            }
+        }
+
+        for (int i = 0; i < NODES; i++) {
+            node_t *n = &nodes[i];
+            if (!n->running) continue;
+            int64_t now = clk_wall(n);
+            if (now < n->next_sec * 1000000LL) continue;
+            n->next_sec = now / 1000000 + 1;
+
+            lansync_local_t local = local_of(n);
+            unsigned ev = lansync_on_second(&n->st, &n->clk, &local);
+            if (n->id == 0x10 && (ev & LANSYNC_EV_CLAIMED)) claimed_by_10 = 1;
+            if (ev & LANSYNC_EV_SEND_BEACON) {
+                lansync_pkt_t pkt;
+                lansync_beacon(&n->st, &n->clk, &local, &pkt);
+                sendto(n->sock, &pkt, sizeof(pkt), 0, (struct sockaddr *)&bcast, sizeof(bcast));
+            }
+        }
+    }
+
+    // Phase of every node against the master at one instant
+    node_t *master = NULL;
+    int masters = 0;
+    for (int i = 0; i < NODES; i++) {
+        if (nodes[i].st.role == LANSYNC_MASTER) { master = &nodes[i]; masters++; }
+    }
+    CHECK(masters == 1);
+    CHECK(master && master->id == 0x10);
+    CHECK(claimed_by_10);
+    CHECK(yielded_20);
+
+    s_frozen = vnow();
+    if (master) {
+        double ref = (double)clk_wall(master);
+        for (int i = 0; i < NODES; i++) {
+            node_t *n = &nodes[i];
+            double err = (double)clk_wall(n) - ref;
+            printf("node %02x %-9s master %02x  phase %+8.1f us  steps %u slews %u  sntp %s\n",
+                   n->id, lansync_role_str(n->st.role), n->st.master_id, err,
+                   n->st.steps, n->st.slews, n->source_on ? "on" : "off");
+            if (n == master) continue;
+            CHECK(n->st.role == LANSYNC_FOLLOWER && n->st.master_id == 0x10);
+            CHECK(err > -1000 && err < 1000);
+            CHECK(!n->source_on || n->id < 0x10);   // followers stop SNTP unless they could lead
+        }
+    }
+
+    CHECK_DONE();
+}
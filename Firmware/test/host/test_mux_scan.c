@@ -0,0 +1,139 @@
+/* Multiplex scan vs. 100 Hz chrono frames (mux_scan.h).
+
+   Simulates the GPTimer alarm (every MUX_PERIOD_US, hardware
+   periodic) and the chrono esp_timer (every 10 ms, dispatched up
+   to a given jitter late), each committing the next hundredth with
+   a new frame sequence number. Alarms run the same mux_scan_next()
+   / mux_scan_latch() as the ISR. For every timer phase and jitter
+   up to 1.9 ms, each hundredth must be latched and the dropped
+   counter must stay 0; every tube must be lit once per scan at a
+   fixed interval. With a 16 ms scan (every other alarm, as before)
+   hundredths are lost, and the counters must report exactly the
+   ones that never reached a latch.
+
+   Usage: test_mux_scan [seconds]      (default 60 per case)
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mux_scan.h"
+#include "check.h"
+
+#define FRAME_US 10000   // one hundredth
+
+static uint32_t s_rng = 2024;
+static uint32_t rnd(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return s_rng >> 8;
+}
+
+typedef struct {
+    uint32_t frames;       // hundredths committed
+    uint32_t shown;        // distinct hundredths that reached a latch
+    uint32_t latched;      // counters from mux_scan_t
+    uint32_t dropped;
+    int64_t  tube_gap_min, tube_gap_max;
+    uint32_t tube_lit[MUX_TUBES];
+} sim_result_t;
+
+/* alarms_per_step: 1 = current ISR, 2 = the old every-other-alarm scan */
+static void simulate(int64_t duration_us, int64_t phase_us, uint32_t jitter_us,
+                     int alarms_per_step, uint32_t seq0, sim_result_t *r)
+{
+    mux_scan_t scan = MUX_SCAN_INIT;
+    scan.seen_seq = seq0;
+    uint32_t seq = seq0;       // s_frame_seq
+    int64_t  shown_cs = -1;    // hundredth in tube_list
+    int64_t  last_latched = -1;
+    int64_t  last_lit[MUX_TUBES];
+    uint32_t alarm = 0;
+
+    size_t nframes = (size_t)(duration_us / FRAME_US) + 2;
+    uint8_t *seen = calloc(nframes, 1);
+
+    memset(r, 0, sizeof(*r));
+    r->tube_gap_min = INT64_MAX;
+    for (int i = 0; i < MUX_TUBES; i++) last_lit[i] = -1;
+
+    int64_t next_alarm = phase_us;
+    int64_t tick = 0;
+    int64_t next_tick = 0;
+    // Ticks stop at the end, the alarms run two more (slow) scans to latch the last frame
+    while (next_alarm < duration_us + 4 * MUX_SCAN_US) {
+        if (next_tick < duration_us && next_tick <= next_alarm) {
+            // chrono_tick: the hundredth at the dispatch time, a new frame each time
+            shown_cs = next_tick / FRAME_US;
+            seq++;
+            r->frames++;
+            tick++;
+            next_tick = tick * FRAME_US + (jitter_us ? (int64_t)(rnd() % jitter_us) : 0);
+            continue;
+        }
+
+        if (alarm++ % (uint32_t)alarms_per_step == 0) {
+            if (mux_scan_next(&scan)) {
+                mux_scan_latch(&scan, seq);
+                if (shown_cs >= 0 && shown_cs != last_latched) {
+                    if (!seen[shown_cs]) r->shown++;
+                    seen[shown_cs] = 1;
+                    last_latched = shown_cs;
+                }
+            }
+            int t = scan.cur_tube;
+            if (last_lit[t] >= 0) {
+                int64_t gap = next_alarm - last_lit[t];
+                if (gap < r->tube_gap_min) r->tube_gap_min = gap;
+                if (gap > r->tube_gap_max) r->tube_gap_max = gap;
+            }
+            last_lit[t] = next_alarm;
+            r->tube_lit[t]++;
+        }
+        next_alarm += MUX_PERIOD_US;
+    }
+    r->latched = scan.latched;
+    r->dropped = scan.dropped;
+    free(seen);
+}
+
+int main(int argc, char **argv)
+{
+    int64_t duration = (argc > 1 ? atoi(argv[1]) : 60) * 1000000LL;
+    static const uint32_t jitters[] = { 0, 500, 1000, 1500, 1900 };
+    sim_result_t r;
+    uint32_t cases = 0, worst_dropped_old = 0;
+
+    for (size_t j = 0; j < sizeof(jitters) / sizeof(jitters[0]); j++) {
+        for (int64_t phase = 0; phase < MUX_SCAN_US; phase += 250) {
+            // Start just below the sequence wrap once per jitter
+            uint32_t seq0 = phase == 0 ? 0xFFFFFF00u : 0;
+            simulate(duration, phase, jitters[j], 1, seq0, &r);
+            cases++;
+
+            if (r.shown != r.frames || r.dropped != 0 || r.latched != r.frames) {
+                fprintf(stderr, "jitter %u us, phase %lld us: %u frames, %u shown, latched %u, dropped %u\n",
+                        jitters[j], (long long)phase, r.frames, r.shown, r.latched, r.dropped);
+                check_failures++;
+            }
+            CHECK(r.tube_gap_min == MUX_SCAN_US && r.tube_gap_max == MUX_SCAN_US);
+            for (int i = 1; i < MUX_TUBES; i++) {
+                CHECK(abs((int)r.tube_lit[i] - (int)r.tube_lit[0]) <= 1);
+            }
+
+            // The old 16 ms scan loses hundredths; the counters must say how many
+            simulate(duration, phase, jitters[j], 2, seq0, &r);
+            CHECK(r.dropped > 0);
+            CHECK(r.latched == r.shown);
+            CHECK(r.latched + r.dropped == r.frames);
+            CHECK(r.tube_gap_min == 2 * MUX_SCAN_US && r.tube_gap_max == 2 * MUX_SCAN_US);
+            if (r.dropped > worst_dropped_old) worst_dropped_old = r.dropped;
+        }
+    }
+
+    printf("%u cases of %lld s: every hundredth latched at a %d us scan; "
+           "a %d us scan drops up to %u of %u\n",
+           cases, (long long)(duration / 1000000), MUX_SCAN_US, 2 * MUX_SCAN_US,
+           worst_dropped_old, (uint32_t)(duration / FRAME_US));
+    CHECK_DONE();
+}
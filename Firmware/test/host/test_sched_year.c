@@ -0,0 +1,337 @@
+/* Scheduler over a simulated year, per time zone.
+
+   The oracle scans every minute of the year with localtime_r() and
+   records, per entry and local date, the first minute whose local
+   time is HH:MM or later. sched.c must produce exactly these
+   occurrences when chained through sched_next_after(), answer
+   next/last queries at random instants, and replay the same
+   blank/brightness state (sched_state_at) that firing every event
+   in order leads to. A model of sched_task, woken for a resync by
+   notifies that land between a due time and the wake-up and by
+   forward clock steps, must still fire every alarm occurrence once
+   (sched_rebase). Also checks validation and the text format.
+
+   Usage: test_sched_year [year]        (default 2027)
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sched.h"
+#include "check.h"
+
+#define MAX_OCC 400
+
+typedef struct {
+    const char *name;
+    const char *tz;
+} zone_t;
+
+/* DST at 02:00, at 02:00/03:00, half-hour DST, at 24:00 (Sat/Sun), none */
+static const zone_t zones[] = {
+    { "Berlin",    "CET-1CEST,M3.5.0,M10.5.0/3" },
+    { "New York",  "EST5EDT,M3.2.0,M11.1.0" },
+    { "Lord Howe", "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0" },
+    { "Santiago",  "<-04>4<-03>,M9.1.6/24,M4.1.6/24" },
+    { "UTC",       "UTC0" },
+};
+
+static uint32_t s_rng = 12345;
+static uint32_t rnd(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return s_rng >> 8;
+}
+
+static time_t s_occ[SCHED_MAX_ENTRIES][MAX_OCC];
+static int    s_occ_n[SCHED_MAX_ENTRIES];
+
+/* Entries around the usual DST hours plus random ones */
+static size_t make_entries(sched_entry_t *e)
+{
+    static const uint8_t edge[][2] = {
+        { 0, 0 }, { 0, 30 }, { 1, 30 }, { 2, 0 }, { 2, 30 }, { 3, 0 }, { 12, 0 }, { 23, 30 }, { 23, 59 },
+    };
+    static const uint8_t masks[] = { SCHED_ALL_DAYS, 0x3E, 0x41, 0x01, 0x40 };
+    size_t n = 0;
+    for (size_t i = 0; i < sizeof(edge) / sizeof(edge[0]); i++, n++) {
+        e[n].days   = masks[i % 5];
+        e[n].hour   = edge[i][0];
+        e[n].minute = edge[i][1];
+        e[n].action = (uint8_t)(i % SCHED_ACT_COUNT);
+        e[n].arg    = e[n].action == SCHED_ACT_BRIGHTNESS ? (uint8_t)(i % 9) : 0;
+    }
+    while (n < SCHED_MAX_ENTRIES) {
+        e[n].days   = (uint8_t)(rnd() % SCHED_ALL_DAYS + 1);
+        e[n].hour   = (uint8_t)(rnd() % 24);
+        e[n].minute = (uint8_t)(rnd() % 60);
+        e[n].action = (uint8_t)(rnd() % SCHED_ACT_COUNT);
+        e[n].arg    = e[n].action == SCHED_ACT_BRIGHTNESS ? (uint8_t)(rnd() % 9) : 0;
+        n++;
+    }
+    return n;
+}
+
+static void oracle(const sched_entry_t *e, size_t n, time_t from, time_t to)
+{
+    int last_day[SCHED_MAX_ENTRIES];
+    memset(s_occ_n, 0, sizeof(s_occ_n));
+    for (size_t i = 0; i < n; i++) last_day[i] = -1;
+
+    for (time_t t = from; t <= to; t += 60) {
+        struct tm tm;
+        localtime_r(&t, &tm);
+        int day = tm.tm_year * 400 + tm.tm_yday;
+        for (size_t i = 0; i < n; i++) {
+            if (last_day[i] == day || !(e[i].days & (1u << tm.tm_wday))) continue;
+            if (tm.tm_hour * 60 + tm.tm_min < e[i].hour * 60 + e[i].minute) continue;
+            last_day[i] = day;
+            // The first day of the scan starts mid-day; skip it
+            if (t - from >= 86400 && s_occ_n[i] < MAX_OCC) s_occ[i][s_occ_n[i]++] = t;
+        }
+    }
+}
+
+/* Oracle answers: first occurrence > t, last <= t */
+static time_t occ_next(size_t i, time_t t)
+{
+    for (int k = 0; k < s_occ_n[i]; k++) if (s_occ[i][k] > t) return s_occ[i][k];
+    return (time_t)-1;
+}
+
+static time_t occ_last(size_t i, time_t t)
+{
+    time_t r = (time_t)-1;
+    for (int k = 0; k < s_occ_n[i] && s_occ[i][k] <= t; k++) r = s_occ[i][k];
+    return r;
+}
+
+static void fmt(time_t t, char *out, size_t size)
+{
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(out, size, "%Y-%m-%d %H:%M:%S %Z", &tm);
+}
+
+/* sched_task as in main.c: fire what is due, or rebase after a notify.
+   A third of the wake-ups find a notify that arrived after the due
+   time (SNTP, LAN step, edit), a sixth follow a forward clock step
+   of up to two hours. Every alarm occurrence must fire exactly once,
+   at its own due time. Returns the number of resyncs. */
+static int resync_year(const zone_t *z, const sched_entry_t *e, size_t n, time_t start, time_t end)
+{
+    static time_t fired[SCHED_MAX_ENTRIES][MAX_OCC];
+    int n_fired[SCHED_MAX_ENTRIES] = { 0 };
+    time_t due[SCHED_MAX_ENTRIES];
+    size_t late[SCHED_MAX_ENTRIES];
+    time_t late_at[SCHED_MAX_ENTRIES];
+    for (size_t i = 0; i < n; i++) due[i] = (time_t)-1;   // as after boot
+
+    time_t t = start;
+    bool resync = true;
+    int resyncs = 0;
+    for (;;) {
+        if (resync) {
+            size_t k = sched_rebase(e, n, t, due, late, late_at);
+            for (size_t j = 0; j < k; j++) {
+                CHECK(e[late[j]].action == SCHED_ACT_ALARM);
+                if (late_at[j] <= end && n_fired[late[j]] < MAX_OCC) fired[late[j]][n_fired[late[j]]++] = late_at[j];
+            }
+            resyncs++;
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                if (due[i] == (time_t)-1 || due[i] > t) continue;
+                if (e[i].action == SCHED_ACT_ALARM && n_fired[i] < MAX_OCC) fired[i][n_fired[i]++] = due[i];
+                due[i] = sched_next_after(&e[i], t);
+            }
+        }
+
+        time_t next = (time_t)-1;
+        for (size_t i = 0; i < n; i++) {
+            if (due[i] != (time_t)-1 && (next == (time_t)-1 || due[i] < next)) next = due[i];
+        }
+        if (next == (time_t)-1 || next > end) break;
+
+        uint32_t r = rnd() % 6;
+        resync = r < 3;
+        if (r < 2)       t = next + (time_t)(rnd() % 3);       // notify in the due window
+        else if (r == 2) t = next + (time_t)(rnd() % 7200);    // clock stepped forward across it
+        else             t = next;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (e[i].action != SCHED_ACT_ALARM) continue;
+        int k = 0, m = 0;
+        while (k < s_occ_n[i] && s_occ[i][k] <= start) k++;
+        for (; k < s_occ_n[i] && s_occ[i][k] <= end; k++, m++) {
+            if (m >= n_fired[i] || fired[i][m] != s_occ[i][k]) break;
+        }
+        if (m != n_fired[i] || (k < s_occ_n[i] && s_occ[i][k] <= end)) {
+            char at[48];
+            fmt(k < s_occ_n[i] ? s_occ[i][k] : end, at, sizeof(at));
+            fprintf(stderr, "%s: alarm entry %zu: %d of its occurrences fired, first mismatch at %s\n",
+                    z->name, i, n_fired[i], at);
+            check_failures++;
+        }
+    }
+    return resyncs;
+}
+
+static void run_zone(const zone_t *z, int year)
+{
+    setenv("TZ", z->tz, 1);
+    tzset();
+
+    struct tm jan1 = { .tm_year = year - 1900, .tm_mon = 0, .tm_mday = 1 };
+    struct tm next = { .tm_year = year + 1 - 1900, .tm_mon = 0, .tm_mday = 1 };
+    time_t start = timegm(&jan1), end = timegm(&next);
+    // Occurrences within [start, end] are compared; the margins keep
+    // next/last queries near the edges answerable by the oracle.
+    time_t from = start - 10 * 86400, to = end + 10 * 86400;
+
+    sched_entry_t e[SCHED_MAX_ENTRIES];
+    size_t n = make_entries(e);
+    for (size_t i = 0; i < n; i++) CHECK(sched_entry_valid(&e[i]));
+    oracle(e, n, from, to);
+
+    // 1. Chaining next_after through the year hits every occurrence once
+    int occurrences = 0;
+    for (size_t i = 0; i < n; i++) {
+        int k = 0;
+        while (k < s_occ_n[i] && s_occ[i][k] <= start) k++;
+        time_t t = sched_next_after(&e[i], start);
+        for (; t != (time_t)-1 && t <= end; t = sched_next_after(&e[i], t), k++) {
+            if (k >= s_occ_n[i] || s_occ[i][k] != t) {
+                char got[48], want[48] = "none";
+                fmt(t, got, sizeof(got));
+                if (k < s_occ_n[i]) fmt(s_occ[i][k], want, sizeof(want));
+                fprintf(stderr, "%s: entry %zu (%02u:%02u days %02x): got %s, oracle %s\n",
+                        z->name, i, e[i].hour, e[i].minute, e[i].days, got, want);
+                check_failures++;
+                break;
+            }
+            occurrences++;
+        }
+        if (k < s_occ_n[i] && s_occ[i][k] <= end && (t == (time_t)-1 || t > end)) {
+            fprintf(stderr, "%s: entry %zu missed occurrences\n", z->name, i);
+            check_failures++;
+        }
+    }
+
+    // 2. Random instants, plus each occurrence of entry 4 and the second around it
+    int queries = 0;
+    for (int q = 0; q < 1500; q++) {
+        time_t t;
+        if (q < 3 * s_occ_n[4]) t = s_occ[4][q / 3] + (q % 3) - 1;
+        else                    t = start + (time_t)(rnd() % (uint32_t)(end - start));
+        if (t < start || t > end) continue;
+        for (size_t i = 0; i < n; i++) {
+            time_t nx = sched_next_after(&e[i], t), ls = sched_last_at_or_before(&e[i], t);
+            if (nx != occ_next(i, t) || ls != occ_last(i, t)) {
+                char at[48];
+                fmt(t, at, sizeof(at));
+                fprintf(stderr, "%s: entry %zu at %s: next %lld/%lld last %lld/%lld\n", z->name, i, at,
+                        (long long)nx, (long long)occ_next(i, t), (long long)ls, (long long)occ_last(i, t));
+                check_failures++;
+            }
+            queries++;
+        }
+    }
+
+    // 3. Fire the year like sched_task does; a reboot right after any
+    //    event must replay the same state
+    time_t due[SCHED_MAX_ENTRIES];
+    sched_state_t st;
+    sched_state_at(e, n, start, &st);
+    int blank = st.blank, bright = st.brightness;
+    for (size_t i = 0; i < n; i++) due[i] = sched_next_after(&e[i], start);
+
+    int events = 0, replays = 0;
+    for (;;) {
+        time_t now = (time_t)-1;
+        for (size_t i = 0; i < n; i++) {
+            if (due[i] != (time_t)-1 && (now == (time_t)-1 || due[i] < now)) now = due[i];
+        }
+        if (now == (time_t)-1 || now > end) break;
+        for (size_t i = 0; i < n; i++) {
+            if (due[i] != now) continue;
+            if (e[i].action == SCHED_ACT_BRIGHTNESS) bright = (int)i;
+            else if (e[i].action != SCHED_ACT_ALARM) blank = (int)i;
+            due[i] = sched_next_after(&e[i], now);
+            events++;
+        }
+        sched_state_at(e, n, now, &st);
+        if (st.blank != blank || st.brightness != bright) {
+            char at[48];
+            fmt(now, at, sizeof(at));
+            fprintf(stderr, "%s: replay at %s: blank %d/%d brightness %d/%d\n",
+                    z->name, at, st.blank, blank, st.brightness, bright);
+            check_failures++;
+        }
+        replays++;
+    }
+    CHECK(events == occurrences);
+
+    int resyncs = resync_year(z, e, n, start, end);
+
+    printf("%-10s %d occurrences, %d queries, %d replays, %d resyncs\n",
+           z->name, occurrences, queries, replays, resyncs);
+}
+
+static void test_format(void)
+{
+    static const char *const ok[] = {
+        "Mo-Fr 07:00 wake", "Sa,Su 09:30 wake", "* 23:00 blank", "* 06:00 brightness 8",
+        "Mo,Sa,Su 00:00 alarm 5", "Mo,We,Fr 12:34 alarm", "Su 23:59 brightness 0",
+    };
+    static const char *const bad[] = {
+        "* 24:00 wake", "* 12:60 wake", "* 12:00 sleep", "* 12:00 brightness",
+        "* 12:00 brightness 9", "* 12:00 alarm 241", "Xx 12:00 wake", "Mo-Xx 12:00 wake",
+        "* 12:00 alarm 300", "", "* 12:00",
+    };
+    char buf[64];
+    sched_entry_t e;
+    for (size_t i = 0; i < sizeof(ok) / sizeof(ok[0]); i++) {
+        CHECK(sched_parse_line(ok[i], &e));
+        sched_format_entry(&e, buf, sizeof(buf));
+        CHECK_STR(buf, ok[i]);
+    }
+    sched_entry_t wrap;
+    CHECK(sched_parse_line("Sa-Mo 00:00 alarm 5", &wrap) && sched_parse_line(ok[4], &e));
+    CHECK(memcmp(&wrap, &e, sizeof(e)) == 0);
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (sched_parse_line(bad[i], &e)) {
+            fprintf(stderr, "accepted \"%s\"\n", bad[i]);
+            check_failures++;
+        }
+    }
+
+    // Arbitrary NVS bytes: whatever passes validation formats and parses back
+    int valid = 0;
+    for (int i = 0; i < 100000; i++) {
+        uint32_t r = rnd(), r2 = rnd();
+        sched_entry_t raw = {
+            .days = (uint8_t)r, .hour = (uint8_t)(r >> 8), .minute = (uint8_t)(r >> 16),
+            .action = (uint8_t)(r2 & 7), .arg = (uint8_t)(r2 >> 8),
+        };
+        if (i & 1) { raw.hour %= 26; raw.minute %= 62; raw.arg %= 250; }
+        if (!sched_entry_valid(&raw)) continue;
+        valid++;
+        if (raw.action == SCHED_ACT_BLANK || raw.action == SCHED_ACT_WAKE) raw.arg = 0;
+        sched_format_entry(&raw, buf, sizeof(buf));
+        CHECK(sched_parse_line(buf, &e) && memcmp(&e, &raw, sizeof(e)) == 0);
+    }
+    CHECK(valid > 0);
+}
+
+int main(int argc, char **argv)
+{
+    int year = argc > 1 ? atoi(argv[1]) : 2027;
+
+    test_format();
+    for (size_t i = 0; i < sizeof(zones) / sizeof(zones[0]); i++) run_zone(&zones[i], year);
+
+    CHECK_DONE();
+}
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""List IV-3 clocks on the local network.
+
+Sends one UDP discovery query (port 12322) to the broadcast address
+and prints every reply that arrives within the timeout. Each clock
+answers with its MAC, firmware version, IP, mode, sync source, sync
+age, last correction and drift. Python 3 standard library only.
+
+    python3 iv3_discover.py                     # 255.255.255.255
+    python3 iv3_discover.py -t 192.168.1.255    # directed subnet broadcast
+    python3 iv3_discover.py --json
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+DISCOVERY_PORT = 12322
+MAGIC_QUERY = 0x49563351  # "IV3Q"
+MAGIC_REPLY = 0x49563352  # "IV3R"
+VERSION = 1
+
+QUERY = struct.pack("!IB3x", MAGIC_QUERY, VERSION)
+# Mirrors discovery_reply_t in Firmware/main/main.c (network byte order)
+REPLY = struct.Struct("!IBBBB6sBx4sIIii32s")
+
+MODES = {0: "sta", 1: "setup-ap"}
+SOURCES = {0: "none", 1: "sntp", 2: "lan"}
+ROLES = {0: "off", 1: "listening", 2: "master", 3: "follower"}
+
+
+def parse_reply(data):
+    if len(data) != REPLY.size:
+        return None
+    (magic, version, mode, source, role, mac, time_set, ip,
+     uptime, age, offset, drift, fw) = REPLY.unpack(data)
+    if magic != MAGIC_REPLY or version != VERSION:
+        return None
+    return {
+        "mac": ":".join("%02x" % b for b in mac),
+        "ip": socket.inet_ntoa(ip),
+        "fw": fw.split(b"\0", 1)[0].decode("ascii", "replace"),
+        "mode": MODES.get(mode, str(mode)),
+        "time_set": bool(time_set),
+        "sync": SOURCES.get(source, str(source)),
+        "lansync": ROLES.get(role, str(role)),
+        "sync_age_s": None if age == 0xFFFFFFFF else age,
+        "offset_us": offset,
+        "drift_ppb": drift,
+        "uptime_s": uptime,
+    }
+
+
+def discover(target, timeout, retries):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    # A few hundred clocks answer at once; make room for the burst
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    sock.bind(("", 0))
+
+    clocks = {}
+    start = time.monotonic()
+    deadline = start + timeout
+    # Repeat the query a few times within the window to cover lost datagrams
+    sends = [start + timeout * i / (retries + 1) for i in range(retries + 1)]
+
+    while True:
+        now = time.monotonic()
+        while sends and sends[0] <= now:
+            sock.sendto(QUERY, (target, DISCOVERY_PORT))
+            sends.pop(0)
+        if now >= deadline:
+            break
+        sock.settimeout(min(deadline, sends[0] if sends else deadline) - now)
+        try:
+            data, _ = sock.recvfrom(256)
+        except socket.timeout:
+            continue
+        info = parse_reply(data)
+        if info:
+            clocks.setdefault(info["mac"], info)
+
+    sock.close()
+    return sorted(clocks.values(), key=lambda c: socket.inet_aton(c["ip"])), time.monotonic() - start
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Find IV-3 clocks on the LAN")
+    ap.add_argument("-t", "--target", default="255.255.255.255",
+                    help="broadcast address (default: 255.255.255.255)")
+    ap.add_argument("-w", "--timeout", type=float, default=0.5,
+                    help="seconds to collect replies (default: 0.5)")
+    ap.add_argument("-r", "--retries", type=int, default=1,
+                    help="extra queries sent within the timeout (default: 1)")
+    ap.add_argument("--json", action="store_true", help="print JSON instead of a table")
+    args = ap.parse_args()
+
+    clocks, elapsed = discover(args.target, args.timeout, args.retries)
+
+    if args.json:
+        json.dump(clocks, sys.stdout, indent=2)
+        print()
+        return 0
+
+    print("%-15s %-17s %-16s %-8s %-5s %-9s %8s %9s %9s" %
+          ("IP", "MAC", "FIRMWARE", "MODE", "SYNC", "LANSYNC", "AGE_S", "OFFS_US", "DRIFT_PPB"))
+    for c in clocks:
+        age = "-" if c["sync_age_s"] is None else str(c["sync_age_s"])
+        print("%-15s %-17s %-16s %-8s %-5s %-9s %8s %9d %9d" %
+              (c["ip"], c["mac"], c["fw"][:16], c["mode"], c["sync"], c["lansync"],
+               age, c["offset_us"], c["drift_ppb"]))
+    print("%d clock(s) in %.0f ms" % (len(clocks), elapsed * 1000), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
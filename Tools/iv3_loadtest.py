@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""Load test for the IV-3 clock web server.
+
+Runs N concurrent clients against a clock for a few seconds per step
+and prints, per concurrency level, the request rate, p50/p99/max
+latency, errors and the number of clients that really had a request
+in flight at the same time. If the clock answers GET /api/status, the
+share of requests that went to the HTTP workers vs. inline on the
+httpd task is printed as well. Python 3 standard library only.
+
+    python3 iv3_loadtest.py 192.168.1.42
+    python3 iv3_loadtest.py 192.168.1.42 -c 1,4,8,12 -d 10
+    python3 iv3_loadtest.py 192.168.1.42 -p /config -p /schedule --close
+    python3 iv3_loadtest.py 192.168.1.42 --short-body /api/value
+
+--short-body announces a longer POST body than it sends, on a
+synchronous handler that runs on the httpd task, and checks that the
+clock gives up with 408 within --stall-limit seconds while GET / is
+still served in the meantime.
+"""
+
+import argparse
+import http.client
+import json
+import socket
+import sys
+import threading
+import time
+
+DEFAULT_PATHS = ["/", "/config", "/schedule", "/api/status"]
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latencies = []
+        self.errors = {}
+        self.in_flight = 0
+        self.peak_in_flight = 0
+
+    def begin(self):
+        with self.lock:
+            self.in_flight += 1
+            self.peak_in_flight = max(self.peak_in_flight, self.in_flight)
+
+    def end(self, latency=None, error=None):
+        with self.lock:
+            self.in_flight -= 1
+            if error is None:
+                self.latencies.append(latency)
+            else:
+                self.errors[error] = self.errors.get(error, 0) + 1
+
+
+def client(host, port, paths, deadline_ref, keepalive, timeout, stats, start_barrier):
+    conn = None
+    i = 0
+    start_barrier.wait()
+    deadline = deadline_ref[0]
+    while time.monotonic() < deadline:
+        path = paths[i % len(paths)]
+        i += 1
+        if conn is None:
+            conn = http.client.HTTPConnection(host, port, timeout=timeout)
+        stats.begin()
+        t0 = time.monotonic()
+        try:
+            conn.request("GET", path, headers={} if keepalive else {"Connection": "close"})
+            resp = conn.getresponse()
+            resp.read()
+            latency = time.monotonic() - t0
+            if resp.status != 200:
+                stats.end(error="HTTP %d" % resp.status)
+            else:
+                stats.end(latency=latency)
+            if not keepalive or resp.will_close:
+                conn.close()
+                conn = None
+        except (OSError, http.client.HTTPException) as e:
+            stats.end(error=type(e).__name__)
+            conn.close()
+            conn = None
+            time.sleep(0.05)   # do not spin on a refused socket
+    if conn is not None:
+        conn.close()
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return float("nan")
+    k = min(len(sorted_values) - 1, max(0, int(round(p / 100.0 * (len(sorted_values) - 1)))))
+    return sorted_values[k]
+
+
+def http_counters(host, port, timeout):
+    """(async, inline) from /api/status, or None"""
+    try:
+        conn = http.client.HTTPConnection(host, port, timeout=timeout)
+        conn.request("GET", "/api/status")
+        data = json.loads(conn.getresponse().read())
+        conn.close()
+        return data["http"]["async"], data["http"]["inline"]
+    except (OSError, ValueError, KeyError, TypeError, http.client.HTTPException):
+        return None
+
+
+def short_body_check(args):
+    """POST that never completes; returns (ok, text)"""
+    body = b"v=1"
+    head = ("POST %s HTTP/1.1\r\nHost: %s\r\n"
+            "Content-Type: application/x-www-form-urlencoded\r\n"
+            "Content-Length: %d\r\n\r\n" % (args.short_body, args.host, len(body) + 100))
+    sock = socket.create_connection((args.host, args.port), timeout=args.stall_limit)
+    t0 = time.monotonic()
+    sock.sendall(head.encode("ascii") + body)
+
+    # The rest of the server must keep answering while the handler waits
+    time.sleep(0.5)
+    side = {}
+    try:
+        conn = http.client.HTTPConnection(args.host, args.port, timeout=args.timeout)
+        t1 = time.monotonic()
+        conn.request("GET", "/")
+        resp = conn.getresponse()
+        resp.read()
+        side = {"status": resp.status, "ms": (time.monotonic() - t1) * 1000}
+        conn.close()
+    except (OSError, http.client.HTTPException) as e:
+        side = {"error": type(e).__name__}
+
+    try:
+        reply = sock.recv(256)
+    except socket.timeout:
+        reply = None
+    except OSError:
+        reply = b""
+    elapsed = time.monotonic() - t0
+    sock.close()
+
+    if reply is None:
+        status = "no answer within %.0f s" % args.stall_limit
+    elif not reply:
+        status = "closed after %.1f s" % elapsed
+    else:
+        status = "%s after %.1f s" % (reply.split(b"\r\n", 1)[0].decode("ascii", "replace"), elapsed)
+    got_408 = reply is not None and b" 408 " in reply.split(b"\r\n", 1)[0]
+    side_ok = side.get("status") == 200
+    side_txt = ("GET / during the stall: HTTP %d in %.0f ms" % (side["status"], side["ms"])
+                if "status" in side else "GET / during the stall: %s" % side["error"])
+    return got_408 and side_ok, "short body on %s: %s; %s" % (args.short_body, status, side_txt)
+
+
+def run_step(args, clients):
+    stats = Stats()
+    barrier = threading.Barrier(clients + 1)
+    threads = []
+    # Deadline is set once all clients are ready, so thread start-up is not measured
+    deadline = [0.0]
+
+    def body():
+        client(args.host, args.port, args.paths, deadline, not args.close,
+               args.timeout, stats, barrier)
+
+    for _ in range(clients):
+        t = threading.Thread(target=body, daemon=True)
+        t.start()
+        threads.append(t)
+    deadline[0] = time.monotonic() + args.duration
+    t0 = time.monotonic()
+    barrier.wait()
+    for t in threads:
+        t.join()
+    elapsed = time.monotonic() - t0
+    return stats, elapsed
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Concurrent GET load against an IV-3 clock")
+    ap.add_argument("host", help="clock IP or host name")
+    ap.add_argument("--port", type=int, default=80)
+    ap.add_argument("-c", "--clients", default="1,2,4,8",
+                    help="comma-separated concurrency levels (default: 1,2,4,8)")
+    ap.add_argument("-d", "--duration", type=float, default=5.0,
+                    help="seconds per level (default: 5)")
+    ap.add_argument("-p", "--path", dest="paths", action="append",
+                    help="path to request, repeatable (default: %s)" % " ".join(DEFAULT_PATHS))
+    ap.add_argument("--close", action="store_true",
+                    help="new connection per request instead of keep-alive")
+    ap.add_argument("--timeout", type=float, default=5.0, help="per-request timeout (default: 5)")
+    ap.add_argument("--json", action="store_true", help="print JSON instead of a table")
+    ap.add_argument("--short-body", metavar="PATH",
+                    help="only check that a POST with a missing body to PATH times out with 408")
+    ap.add_argument("--stall-limit", type=float, default=15.0,
+                    help="seconds the clock may take to give up on the body (default: 15)")
+    args = ap.parse_args()
+    args.paths = args.paths or DEFAULT_PATHS
+
+    if args.short_body:
+        ok, text = short_body_check(args)
+        print(text)
+        return 0 if ok else 1
+    levels = [int(c) for c in args.clients.split(",") if c.strip()]
+
+    results = []
+    if not args.json:
+        print("%7s %6s %8s %8s %8s %8s %6s %9s %s" %
+              ("CLIENTS", "PEAK", "REQ", "REQ/S", "P50_MS", "P99_MS", "MAX_MS", "ASYNC/IN", "ERRORS"))
+    for clients in levels:
+        before = http_counters(args.host, args.port, args.timeout)
+        stats, elapsed = run_step(args, clients)
+        after = http_counters(args.host, args.port, args.timeout)
+
+        lat = sorted(stats.latencies)
+        row = {
+            "clients": clients,
+            "peak_in_flight": stats.peak_in_flight,
+            "requests": len(lat),
+            "req_per_s": len(lat) / elapsed if elapsed > 0 else 0.0,
+            "p50_ms": percentile(lat, 50) * 1000,
+            "p99_ms": percentile(lat, 99) * 1000,
+            "max_ms": (lat[-1] * 1000) if lat else float("nan"),
+            "errors": stats.errors,
+        }
+        if before and after:
+            row["async"] = after[0] - before[0]
+            row["inline"] = after[1] - before[1]
+        results.append(row)
+
+        if not args.json:
+            split = "%d/%d" % (row["async"], row["inline"]) if "async" in row else "-"
+            errors = ", ".join("%s=%d" % kv for kv in sorted(stats.errors.items())) or "-"
+            print("%7d %6d %8d %8.1f %8.1f %8.1f %6.0f %9s %s" %
+                  (clients, row["peak_in_flight"], row["requests"], row["req_per_s"],
+                   row["p50_ms"], row["p99_ms"], row["max_ms"], split, errors))
+            sys.stdout.flush()
+
+    if args.json:
+        json.dump(results, sys.stdout, indent=2)
+        print()
+    return 1 if any(r["requests"] == 0 for r in results) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
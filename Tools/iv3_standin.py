@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Stand-in discovery responders for testing without hardware.
+
+Opens N UDP sockets on the discovery port (12322) with SO_REUSEADDR,
+so every one of them receives each broadcast query, and answers like
+N clocks would: one reply per socket with its own MAC, IP and sync
+figures, in the wire format iv3_discover.py parses. Replies go out
+as fast as the sockets allow, so the burst is harsher than real
+clocks spread over a WLAN. Python 3 standard library only.
+
+    python3 iv3_standin.py -n 200 &
+    python3 iv3_discover.py -t 127.255.255.255
+
+Only broadcast queries reach every socket; a unicast query to
+127.0.0.1 is answered by one of them. Ctrl-C prints the number of
+queries answered.
+"""
+
+import argparse
+import os
+import select
+import socket
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from iv3_discover import DISCOVERY_PORT, MAGIC_QUERY, MAGIC_REPLY, QUERY, REPLY, VERSION  # noqa: E402
+
+
+def make_reply(i, fw):
+    mac = bytes([0x02, 0x49, 0x56, 0x33, (i >> 8) & 0xFF, i & 0xFF])   # locally administered
+    ip = socket.inet_aton("10.%d.%d.%d" % (i >> 16 & 0xFF, i >> 8 & 0xFF, i & 0xFF))
+    source = (1, 2, 0)[i % 3]          # sntp, lan, none
+    role = (2, 3, 0)[i % 3]            # master, follower, off
+    age = 0xFFFFFFFF if source == 0 else 5 + i % 60
+    drift = (i % 11 - 5) * 1000 if source == 1 else 0   # only SNTP clocks measure drift
+    return REPLY.pack(MAGIC_REPLY, VERSION, 0, source, role, mac, 1 if source else 0, ip,
+                      3600 + i, age, (i % 7 - 3) * 125, drift, fw.encode("ascii")[:31])
+
+
+def open_socket(port):
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    s.bind(("", port))
+    s.setblocking(False)
+    return s
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Answer IV-3 discovery queries as N fake clocks")
+    ap.add_argument("-n", "--clocks", type=int, default=50, help="number of clocks (default: 50)")
+    ap.add_argument("--port", type=int, default=DISCOVERY_PORT)
+    ap.add_argument("--fw", default="standin", help="firmware version to report")
+    args = ap.parse_args()
+
+    socks = [open_socket(args.port) for _ in range(args.clocks)]
+    replies = {s.fileno(): make_reply(i + 1, args.fw) for i, s in enumerate(socks)}
+    by_fd = {s.fileno(): s for s in socks}
+    answered = 0
+    print("%d stand-in clocks on UDP %d" % (len(socks), args.port), file=sys.stderr)
+
+    poll = select.poll()
+    for s in socks:
+        poll.register(s, select.POLLIN)
+    try:
+        while True:
+            for fd, _ in poll.poll():
+                s = by_fd[fd]
+                while True:
+                    try:
+                        data, src = s.recvfrom(64)
+                    except BlockingIOError:
+                        break
+                    if len(data) != len(QUERY):
+                        continue
+                    magic, version = struct.unpack("!IB3x", data)
+                    if magic != MAGIC_QUERY or version != VERSION:
+                        continue
+                    s.sendto(replies[fd], src)
+                    answered += 1
+    except KeyboardInterrupt:
+        pass
+    print("%d queries answered" % answered, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())